@@ -4,13 +4,441 @@
 #include <memory>
 #include <mutex>
 #include <condition_variable>
+#include <shared_mutex>
 #include <thread>
 #include <stdexcept>
+#include <atomic>
+#include <functional>
+#include <memory_resource>
+#include <chrono>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <climits>
+#include <queue>
+#include <deque>
+#include <map>
+#include <array>
+#include <string_view>
+#include <cmath>
+#include <cctype>
+#include <cstring>
+#include <unordered_set>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cerrno>
+#include <new>
+#include <random>
+#include <cstdarg>
+#include <exception>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <linux/membarrier.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
 // Forward declarations
 class ServiceCenter;
+class ServiceAppointment;
+
+// Compact tags used by indexes and history records
+enum class ServiceKind : uint8_t { OilChange, EngineRepair };
+enum class StateKind : uint8_t { Scheduled, InProgress, Completed, Cancelled };
+
+constexpr size_t kServiceKindCount = 2;
+constexpr size_t kStateKindCount = 4;
+
+inline const char* serviceKindName(ServiceKind kind) {
+    static const char* const names[kServiceKindCount] = {"Oil Change", "Engine Repair"};
+    return names[static_cast<size_t>(kind)];
+}
+
+inline const char* stateKindName(StateKind kind) {
+    static const char* const names[kStateKindCount] = {"Scheduled", "In Progress", "Completed", "Cancelled"};
+    return names[static_cast<size_t>(kind)];
+}
+
+// Day numbers count days since 01-01-1970 (proleptic Gregorian calendar)
+constexpr int32_t kInvalidDay = INT32_MIN;
+
+inline int32_t daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const int yoe = year - era * 400;
+    const int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+inline void civilFromDays(int32_t days, int& year, int& month, int& day) {
+    days += 719468;
+    const int era = (days >= 0 ? days : days - 146096) / 146097;
+    const int doe = days - era * 146097;
+    const int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const int mp = (5 * doy + 2) / 153;
+    day = doy - (153 * mp + 2) / 5 + 1;
+    month = mp < 10 ? mp + 3 : mp - 9;
+    year = yoe + era * 400 + (month <= 2);
+}
+
+inline int daysInMonth(int year, int month) {
+    static const uint8_t days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    return days[month - 1] + (month == 2 && leap);
+}
+
+// Parses a canonical DD-MM-YYYY date with calendar validation; returns
+// kInvalidDay otherwise. Digit checks are folded into one flag word.
+inline int32_t parseDate(string_view date) {
+    if (date.size() != 10) return kInvalidDay;
+    unsigned bad = (date[2] != '-') | (date[5] != '-');
+    auto digit = [&](size_t i) {
+        unsigned value = static_cast<unsigned>(static_cast<uint8_t>(date[i])) - '0';
+        bad |= value > 9;
+        return value;
+    };
+    unsigned day = digit(0) * 10 + digit(1);
+    unsigned month = digit(3) * 10 + digit(4);
+    unsigned year = digit(6) * 1000 + digit(7) * 100 + digit(8) * 10 + digit(9);
+    bad |= (month - 1 > 11) | (year < 1900);
+    if (bad || day - 1 >= static_cast<unsigned>(daysInMonth(year, month))) return kInvalidDay;
+    return daysFromCivil(year, month, day);
+}
+
+inline string formatDate(int32_t days) {
+    if (days == kInvalidDay) return "unknown date";
+    int year, month, day;
+    civilFromDays(days, year, month, day);
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%02d-%02d-%04d", day, month, year);
+    return buffer;
+}
+
+// Byte tables for the normalization kernels. Every byte maps to its canonical
+// form plus a keep flag, so the scalar loops carry no data-dependent branches.
+struct NormalizationTables {
+    uint8_t upper[256];
+    uint8_t plateKeep[256];
+    uint8_t digit[256];
+
+    NormalizationTables() {
+        for (int c = 0; c < 256; ++c) {
+            bool isDigit = c >= '0' && c <= '9';
+            bool isLower = c >= 'a' && c <= 'z';
+            bool isUpper = c >= 'A' && c <= 'Z';
+            upper[c] = static_cast<uint8_t>(isLower ? c - 32 : c);
+            plateKeep[c] = isDigit || isLower || isUpper;
+            digit[c] = isDigit;
+        }
+    }
+};
+
+inline const NormalizationTables& normalizationTables() {
+    static const NormalizationTables tables;
+    return tables;
+}
+
+constexpr size_t kMaxPlateLength = 15;
+
+// Uppercases and drops everything but letters and digits. `out` needs room for
+// raw.size() bytes. With SSE2, inputs of 8 to 16 bytes (every plate as typed)
+// are classified in one register built from two overlapping 8-byte loads, so
+// nothing is read past the input; rejected bytes are squeezed out by walking
+// the keep mask.
+inline size_t normalizePlateInto(string_view raw, char* out) {
+    const NormalizationTables& tables = normalizationTables();
+    size_t i = 0, n = 0;
+#ifdef __SSE2__
+    if (raw.size() >= 8 && raw.size() <= 16) {
+        size_t len = raw.size(), overlap = 16 - len;
+        uint64_t head, tail;
+        memcpy(&head, raw.data(), 8);
+        memcpy(&tail, raw.data() + len - 8, 8);
+        __m128i v = _mm_set_epi64x(static_cast<long long>(tail), static_cast<long long>(head));
+        auto inRange = [](__m128i x, char lo, char hi) {
+            return _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8(static_cast<char>(lo - 1))),
+                                 _mm_cmplt_epi8(x, _mm_set1_epi8(static_cast<char>(hi + 1))));
+        };
+        v = _mm_sub_epi8(v, _mm_and_si128(inRange(v, 'a', 'z'), _mm_set1_epi8(0x20)));
+        __m128i keepBytes = _mm_or_si128(inRange(v, 'A', 'Z'), inRange(v, '0', '9'));
+        unsigned keep = static_cast<unsigned>(_mm_movemask_epi8(keepBytes));
+        // Bytes 8..8+overlap of the register repeat the end of the head
+        unsigned duplicate = ((1u << overlap) - 1) << 8;
+        if ((keep | duplicate) == 0xFFFF) {
+            // Already canonical: write both halves back, overlapping as loaded
+            memcpy(out, &v, 8);
+            memcpy(out + len - 8, reinterpret_cast<const char*>(&v) + 8, 8);
+            return len;
+        }
+        alignas(16) char chunk[16];
+        _mm_store_si128(reinterpret_cast<__m128i*>(chunk), v);
+        for (keep &= ~duplicate; keep; keep &= keep - 1) out[n++] = chunk[__builtin_ctz(keep)];
+        return n;
+    }
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    auto inRange = [](__m128i x, char lo, char hi) {
+        return _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8(static_cast<char>(lo - 1))),
+                             _mm_cmplt_epi8(x, _mm_set1_epi8(static_cast<char>(hi + 1))));
+    };
+    for (; i + 16 <= raw.size(); i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw.data() + i));
+        v = _mm_sub_epi8(v, _mm_and_si128(inRange(v, 'a', 'z'), caseBit));
+        __m128i keep = _mm_or_si128(inRange(v, 'A', 'Z'), inRange(v, '0', '9'));
+        if (_mm_movemask_epi8(keep) != 0xFFFF) break;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + n), v);
+        n += 16;
+    }
+#endif
+    for (; i < raw.size(); ++i) {
+        uint8_t c = static_cast<uint8_t>(raw[i]);
+        out[n] = static_cast<char>(tables.upper[c]);
+        n += tables.plateKeep[c];
+    }
+    return n;
+}
+
+// Canonical plate ("ka 05 ab-1234" -> "KA05AB1234"), empty when invalid
+inline string normalizePlate(string_view raw) {
+    char buffer[64];
+    string scratch;
+    char* out = buffer;
+    if (raw.size() > sizeof(buffer)) {
+        scratch.resize(raw.size());
+        out = &scratch[0];
+    }
+    size_t n = normalizePlateInto(raw, out);
+    if (n < 2 || n > kMaxPlateLength) return string();
+    return string(out, n);
+}
+
+// Keeps digits and a leading '+'; valid numbers carry 7 to 15 digits (E.164)
+inline string normalizePhone(string_view raw) {
+    const NormalizationTables& tables = normalizationTables();
+    string out(raw.size(), '\0');
+    size_t n = 0, lead = 0;
+    for (size_t i = 0; i < raw.size(); ++i) {
+        uint8_t c = static_cast<uint8_t>(raw[i]);
+        out[n] = static_cast<char>(c);
+        size_t plus = (c == '+') & (n == 0);
+        n += tables.digit[c] | plus;
+        lead |= plus;
+    }
+    size_t digits = n - lead;
+    if (digits < 7 || digits > 15) return string();
+    out.resize(n);
+    return out;
+}
+
+// Trims the input and accepts '/', '.' or '-' separators with one- or
+// two-digit day and month; returns canonical DD-MM-YYYY or empty when invalid
+inline string normalizeDate(string_view raw) {
+    size_t begin = 0, end = raw.size();
+    while (begin < end && isspace(static_cast<unsigned char>(raw[begin]))) ++begin;
+    while (end > begin && isspace(static_cast<unsigned char>(raw[end - 1]))) --end;
+    raw = raw.substr(begin, end - begin);
+
+    char canonical[10];
+    size_t fields[3] = {0, 0, 0}, lengths[3] = {0, 0, 0}, field = 0;
+    for (size_t i = 0; i < raw.size(); ++i) {
+        char c = raw[i];
+        if (c == '-' || c == '/' || c == '.') {
+            if (++field > 2) return string();
+            fields[field] = i + 1;
+        } else {
+            ++lengths[field];
+        }
+    }
+    if (field != 2 || lengths[0] < 1 || lengths[0] > 2 || lengths[1] < 1 || lengths[1] > 2 || lengths[2] != 4) {
+        return string();
+    }
+    auto copyPadded = [&](size_t index, char* out) {
+        if (lengths[index] == 1) { out[0] = '0'; out[1] = raw[fields[index]]; }
+        else { out[0] = raw[fields[index]]; out[1] = raw[fields[index] + 1]; }
+    };
+    copyPadded(0, canonical);
+    canonical[2] = '-';
+    copyPadded(1, canonical + 3);
+    canonical[5] = '-';
+    for (size_t i = 0; i < 4; ++i) canonical[6 + i] = raw[fields[2] + i];
+
+    string_view result(canonical, sizeof(canonical));
+    if (parseDate(result) == kInvalidDay) return string();
+    return string(result);
+}
+
+// Raw booking fields as typed at the desk or read from an import file
+struct BookingFields {
+    string clientName;
+    string contact;
+    string vehicleNumber;
+    string date;
+};
+
+enum BookingFieldError : uint8_t {
+    kBadPlate = 1,
+    kBadContact = 2,
+    kBadDate = 4,
+    kBadName = 8
+};
+
+// Canonicalizes a booking in place and returns a mask of BookingFieldError
+inline uint8_t normalizeBooking(BookingFields& fields) {
+    uint8_t errors = 0;
+    size_t begin = fields.clientName.find_first_not_of(" \t");
+    size_t end = fields.clientName.find_last_not_of(" \t");
+    fields.clientName = begin == string::npos ? string() : fields.clientName.substr(begin, end - begin + 1);
+    errors |= fields.clientName.empty() ? kBadName : 0;
+
+    fields.vehicleNumber = normalizePlate(fields.vehicleNumber);
+    errors |= fields.vehicleNumber.empty() ? kBadPlate : 0;
+    fields.contact = normalizePhone(fields.contact);
+    errors |= fields.contact.empty() ? kBadContact : 0;
+    fields.date = normalizeDate(fields.date);
+    errors |= fields.date.empty() ? kBadDate : 0;
+    return errors;
+}
+
+// Bulk-import path: normalizes every row and returns one error mask per row
+inline vector<uint8_t> normalizeBookings(vector<BookingFields>& rows) {
+    vector<uint8_t> errors(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) errors[i] = normalizeBooking(rows[i]);
+    return errors;
+}
+
+inline string describeBookingErrors(uint8_t errors) {
+    string message = "Invalid booking";
+    const char* separator = ": ";
+    auto add = [&](uint8_t flag, const char* text) {
+        if (!(errors & flag)) return;
+        message += separator;
+        message += text;
+        separator = "; ";
+    };
+    add(kBadName, "client name is empty");
+    add(kBadContact, "contact must have 7-15 digits");
+    add(kBadPlate, "vehicle number must have 2-15 letters or digits");
+    add(kBadDate, "date must be a real DD-MM-YYYY date");
+    return message;
+}
+
+// Fixed-capacity string stored inline (N + 1 bytes, never allocates) for
+// short bounded fields such as plates and phone numbers
+template <size_t N>
+class InlineString {
+private:
+    static_assert(N < 256, "InlineString length must fit in one byte");
+    char chars[N];
+    uint8_t length = 0;
+
+public:
+    InlineString() = default;
+
+    explicit InlineString(string_view text) {
+        if (text.size() > N) throw length_error("Value exceeds field capacity");
+        memcpy(chars, text.data(), text.size());
+        length = static_cast<uint8_t>(text.size());
+    }
+
+    string_view view() const { return string_view(chars, length); }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+
+    bool operator==(const InlineString& other) const { return view() == other.view(); }
+};
+
+using PlateString = InlineString<kMaxPlateLength>;
+using PhoneString = InlineString<16>;
+using DateString = InlineString<10>;
+
+// Interns client names into append-only blocks drawn from the owning center's
+// memory resource. Equal values share one copy and the returned views stay
+// valid until the pool, and with it the center, is destroyed. Not locked: a
+// center only interns while holding its book lock.
+class StringPool {
+private:
+    // Blocks start small for branch-sized centers and double up to the cap
+    static constexpr size_t kFirstBlockBytes = 512;
+    static constexpr size_t kBlockBytes = 16 * 1024;
+
+    struct Block {
+        char* data;
+        size_t bytes;
+    };
+
+    pmr::memory_resource* resource;
+    pmr::unordered_set<string_view> values;
+    pmr::vector<Block> blocks;
+    char* current = nullptr;
+    size_t blockSize = 0;
+    size_t blockUsed = 0;
+    size_t bytesStored = 0;
+    size_t bytesReserved = 0;
+
+    char* allocateBlock(size_t bytes) {
+        char* data = static_cast<char*>(resource->allocate(bytes, 1));
+        blocks.push_back({data, bytes});
+        bytesReserved += bytes;
+        return data;
+    }
+
+    string_view store(string_view text) {
+        if (text.size() > kBlockBytes / 4) {
+            char* out = allocateBlock(text.size());
+            memcpy(out, text.data(), text.size());
+            return string_view(out, text.size());
+        }
+        if (blockUsed + text.size() > blockSize) {
+            blockSize = blockSize ? min(blockSize * 2, kBlockBytes) : kFirstBlockBytes;
+            while (blockSize < text.size()) blockSize *= 2;
+            current = allocateBlock(blockSize);
+            blockUsed = 0;
+        }
+        char* out = current + blockUsed;
+        memcpy(out, text.data(), text.size());
+        blockUsed += text.size();
+        return string_view(out, text.size());
+    }
+
+public:
+    explicit StringPool(pmr::memory_resource* resource = pmr::get_default_resource())
+        : resource(resource), values(resource), blocks(resource) {}
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    ~StringPool() {
+        for (const Block& block : blocks) resource->deallocate(block.data, block.bytes, 1);
+    }
+
+    string_view intern(string_view text) {
+        if (text.empty()) return string_view();
+        auto it = values.find(text);
+        if (it != values.end()) return *it;
+        string_view stored = store(text);
+        values.insert(stored);
+        bytesStored += text.size();
+        return stored;
+    }
+
+    size_t uniqueValues() const { return values.size(); }
+    size_t storedBytes() const { return bytesStored; }
+    size_t reservedBytes() const { return bytesReserved; }
+};
 
 // Observer Pattern - Interface for notifications
 class ServiceObserver {
@@ -22,234 +450,6791 @@ public:
 // Client class that implements the observer
 class Client : public ServiceObserver {
 private:
-    string name;
-    string contact;
+    string_view name;      // interned in the owning center's pool
+    PhoneString contact;
+    uint32_t id;           // dense per center, keys per-client statistics
 
 public:
-    Client(const string& name, const string& contact) 
-        : name(name), contact(contact) {}
+    Client(StringPool& names, string_view name, string_view contact, uint32_t id = 0)
+        : name(names.intern(name)), contact(contact), id(id) {}
 
     void update(const string& message) override {
         cout << "Notification for " << name << ": " << message << endl;
     }
 
-    string getName() const { return name; }
+    string_view getName() const { return name; }
+    string_view getContact() const { return contact.view(); }
+    uint32_t getId() const { return id; }
+
+    // "Name (contact)" label for reports
+    string getKey() const {
+        string key(name);
+        key += " (";
+        key += contact.view();
+        key += ')';
+        return key;
+    }
 };
 
-// State Pattern - Service States
-class ServiceState {
+// Observer for parties other than the booking client, such as fleet
+// managers, insurers and dashboards
+class Watcher : public ServiceObserver {
+private:
+    string name;
+
 public:
-    virtual string getStatus() = 0;
-    virtual void nextState(class ServiceAppointment* appointment) = 0;
-    virtual ~ServiceState() = default;
+    explicit Watcher(string name) : name(move(name)) {}
+
+    void update(const string& message) override {
+        cout << "Notification for " << name << ": " << message << endl;
+    }
+
+    const string& getName() const { return name; }
 };
 
-class ScheduledState : public ServiceState {
+// State Pattern - Service workflows. Each workflow is compiled from config
+// into a dense state x event table, so a transition is one table lookup.
+using WorkflowGuard = function<bool(const ServiceAppointment&)>;
+using WorkflowHook = function<void(ServiceAppointment&, string_view from, string_view to)>;
+
+// Named guard predicates and transition hooks that configs may refer to
+class WorkflowActions {
+private:
+    unordered_map<string, WorkflowGuard> guards;
+    unordered_map<string, WorkflowHook> hooks;
+
 public:
-    string getStatus() override { return "Scheduled"; }
-    void nextState(ServiceAppointment* appointment) override;
+    void addGuard(const string& name, WorkflowGuard guard) { guards[name] = move(guard); }
+    void addHook(const string& name, WorkflowHook hook) { hooks[name] = move(hook); }
+
+    const WorkflowGuard* findGuard(const string& name) const {
+        auto it = guards.find(name);
+        return it == guards.end() ? nullptr : &it->second;
+    }
+
+    const WorkflowHook* findHook(const string& name) const {
+        auto it = hooks.find(name);
+        return it == hooks.end() ? nullptr : &it->second;
+    }
 };
 
-class InProgressState : public ServiceState {
+class Workflow {
+public:
+    static constexpr uint8_t kNone = 0xFF;
+
+    struct Transition {
+        uint8_t target = kNone;
+        uint8_t guard = kNone;
+        uint8_t hook = kNone;
+    };
+
+private:
+    friend class WorkflowLoader;
+
+    string name;
+    vector<string> stateIds;
+    vector<string> labels;
+    vector<StateKind> phases;
+    vector<string> eventNames;
+    vector<Transition> table;       // stateIds.size() x eventNames.size()
+    vector<WorkflowGuard> guards;
+    vector<WorkflowHook> hooks;
+    uint8_t initialState = kNone;
+    uint8_t progressEvent = kNone;
+
 public:
-    string getStatus() override { return "In Progress"; }
-    void nextState(ServiceAppointment* appointment) override;
+    const string& getName() const { return name; }
+    uint8_t initial() const { return initialState; }
+    uint8_t nextEvent() const { return progressEvent; }
+    size_t stateCount() const { return stateIds.size(); }
+    size_t eventCount() const { return eventNames.size(); }
+
+    string_view label(uint8_t state) const { return labels[state]; }
+    StateKind phase(uint8_t state) const { return phases[state]; }
+    const Transition& transition(uint8_t state, uint8_t event) const {
+        return table[state * eventNames.size() + event];
+    }
+    const WorkflowGuard& guard(uint8_t id) const { return guards[id]; }
+    const WorkflowHook& hook(uint8_t id) const { return hooks[id]; }
+
+    uint8_t eventId(string_view event) const {
+        for (size_t i = 0; i < eventNames.size(); ++i) {
+            if (eventNames[i] == event) return static_cast<uint8_t>(i);
+        }
+        return kNone;
+    }
+
+    // Events that can fire from a state, for prompts
+    vector<string_view> eventsFrom(uint8_t state) const {
+        vector<string_view> result;
+        for (size_t e = 0; e < eventNames.size(); ++e) {
+            if (transition(state, static_cast<uint8_t>(e)).target != kNone) result.push_back(eventNames[e]);
+        }
+        return result;
+    }
 };
 
-class CompletedState : public ServiceState {
+// Workflows parsed from config, plus which one each service type uses
+struct WorkflowSet {
+    vector<shared_ptr<const Workflow>> workflows;
+    array<shared_ptr<const Workflow>, kServiceKindCount> byService;
+};
+
+// Parses workflow config:
+//   workflow <name>
+//     state <Id> <Scheduled|InProgress|Completed|Cancelled> [label words]
+//     initial <Id>
+//     next <event>                 fired by "Progress Appointment"
+//     on <From|*> <event> -> <To> [guard=<name>] [hook=<name>]
+//   end
+//   use <workflow> for <oil|engine>
+// '#' starts a comment.
+class WorkflowLoader {
+private:
+    struct PendingTransition {
+        string from, event, to, guard, hook;
+        size_t line;
+    };
+
+    const WorkflowActions& actions;
+    size_t lineNumber = 0;
+
+    [[noreturn]] void fail(const string& message) const {
+        throw invalid_argument("Workflow config line " + to_string(lineNumber) + ": " + message);
+    }
+
+    static bool parsePhase(const string& text, StateKind& phase) {
+        static const pair<const char*, StateKind> phases[] = {
+            {"Scheduled", StateKind::Scheduled}, {"InProgress", StateKind::InProgress},
+            {"Completed", StateKind::Completed}, {"Cancelled", StateKind::Cancelled}};
+        for (const auto& entry : phases) {
+            if (text == entry.first) { phase = entry.second; return true; }
+        }
+        return false;
+    }
+
+    static uint8_t indexOf(const vector<string>& names, const string& name) {
+        auto it = find(names.begin(), names.end(), name);
+        return it == names.end() ? Workflow::kNone : static_cast<uint8_t>(it - names.begin());
+    }
+
+    static uint8_t internName(vector<string>& names, const string& name) {
+        uint8_t id = indexOf(names, name);
+        if (id != Workflow::kNone) return id;
+        names.push_back(name);
+        return static_cast<uint8_t>(names.size() - 1);
+    }
+
+    shared_ptr<const Workflow> compile(Workflow& wf, const string& initial, const string& next,
+                                       const vector<PendingTransition>& pending) {
+        if (wf.stateIds.empty()) fail("workflow '" + wf.name + "' has no states");
+        wf.initialState = indexOf(wf.stateIds, initial.empty() ? wf.stateIds.front() : initial);
+        if (wf.initialState == Workflow::kNone) fail("unknown initial state '" + initial + "'");
+
+        vector<string> guardNames, hookNames;
+        for (const auto& t : pending) {
+            internName(wf.eventNames, t.event);
+            if (!t.guard.empty()) internName(guardNames, t.guard);
+            if (!t.hook.empty()) internName(hookNames, t.hook);
+        }
+        if (wf.eventNames.size() >= Workflow::kNone) fail("too many events");
+        wf.progressEvent = next.empty() ? Workflow::kNone : indexOf(wf.eventNames, next);
+        if (!next.empty() && wf.progressEvent == Workflow::kNone) fail("next event '" + next + "' has no transitions");
+
+        for (const auto& name : guardNames) {
+            const WorkflowGuard* guard = actions.findGuard(name);
+            if (!guard) fail("unknown guard '" + name + "'");
+            wf.guards.push_back(*guard);
+        }
+        for (const auto& name : hookNames) {
+            const WorkflowHook* hook = actions.findHook(name);
+            if (!hook) fail("unknown hook '" + name + "'");
+            wf.hooks.push_back(*hook);
+        }
+
+        wf.table.assign(wf.stateIds.size() * wf.eventNames.size(), Workflow::Transition{});
+        for (const auto& t : pending) {
+            lineNumber = t.line;
+            uint8_t to = indexOf(wf.stateIds, t.to);
+            if (to == Workflow::kNone) fail("unknown state '" + t.to + "'");
+            Workflow::Transition entry{to,
+                                       t.guard.empty() ? Workflow::kNone : indexOf(guardNames, t.guard),
+                                       t.hook.empty() ? Workflow::kNone : indexOf(hookNames, t.hook)};
+            uint8_t event = indexOf(wf.eventNames, t.event);
+            if (t.from == "*") {
+                for (size_t state = 0; state < wf.stateIds.size(); ++state) {
+                    StateKind phase = wf.phases[state];
+                    bool terminal = phase == StateKind::Completed || phase == StateKind::Cancelled;
+                    if (!terminal && state != to) wf.table[state * wf.eventNames.size() + event] = entry;
+                }
+            } else {
+                uint8_t from = indexOf(wf.stateIds, t.from);
+                if (from == Workflow::kNone) fail("unknown state '" + t.from + "'");
+                wf.table[from * wf.eventNames.size() + event] = entry;
+            }
+        }
+        return make_shared<Workflow>(move(wf));
+    }
+
 public:
-    string getStatus() override { return "Completed"; }
-    void nextState(ServiceAppointment* appointment) override;
+    explicit WorkflowLoader(const WorkflowActions& actions) : actions(actions) {}
+
+    WorkflowSet load(istream& in) {
+        WorkflowSet result;
+        unique_ptr<Workflow> current;
+        string initial, next;
+        vector<PendingTransition> pending;
+        string line;
+
+        while (getline(in, line)) {
+            ++lineNumber;
+            line = line.substr(0, line.find('#'));
+            istringstream words(line);
+            string keyword;
+            if (!(words >> keyword)) continue;
+
+            if (keyword == "workflow") {
+                if (current) fail("missing 'end' before new workflow");
+                current = make_unique<Workflow>();
+                if (!(words >> current->name)) fail("workflow needs a name");
+                initial.clear();
+                next.clear();
+                pending.clear();
+            } else if (keyword == "end") {
+                if (!current) fail("'end' outside a workflow");
+                result.workflows.push_back(compile(*current, initial, next, pending));
+                current.reset();
+            } else if (keyword == "use") {
+                string name, word, service;
+                if (!(words >> name >> word >> service) || word != "for") fail("expected 'use <workflow> for <oil|engine>'");
+                auto it = find_if(result.workflows.begin(), result.workflows.end(),
+                                  [&](const shared_ptr<const Workflow>& wf) { return wf->getName() == name; });
+                if (it == result.workflows.end()) fail("unknown workflow '" + name + "'");
+                if (service == "oil") result.byService[static_cast<size_t>(ServiceKind::OilChange)] = *it;
+                else if (service == "engine") result.byService[static_cast<size_t>(ServiceKind::EngineRepair)] = *it;
+                else fail("unknown service type '" + service + "'");
+            } else if (!current) {
+                fail("'" + keyword + "' outside a workflow");
+            } else if (keyword == "state") {
+                string id, phaseText, label;
+                StateKind phase;
+                if (!(words >> id >> phaseText) || !parsePhase(phaseText, phase)) fail("expected 'state <Id> <Phase> [label]'");
+                if (indexOf(current->stateIds, id) != Workflow::kNone) fail("duplicate state '" + id + "'");
+                if (current->stateIds.size() + 1 >= Workflow::kNone) fail("too many states");
+                getline(words >> ws, label);
+                current->stateIds.push_back(id);
+                current->labels.push_back(label.empty() ? id : label);
+                current->phases.push_back(phase);
+            } else if (keyword == "initial") {
+                if (!(words >> initial)) fail("expected 'initial <Id>'");
+            } else if (keyword == "next") {
+                if (!(words >> next)) fail("expected 'next <event>'");
+            } else if (keyword == "on") {
+                PendingTransition t;
+                string arrow, option;
+                if (!(words >> t.from >> t.event >> arrow >> t.to) || arrow != "->") {
+                    fail("expected 'on <From> <event> -> <To>'");
+                }
+                while (words >> option) {
+                    if (option.compare(0, 6, "guard=") == 0) t.guard = option.substr(6);
+                    else if (option.compare(0, 5, "hook=") == 0) t.hook = option.substr(5);
+                    else fail("unknown option '" + option + "'");
+                }
+                t.line = lineNumber;
+                pending.push_back(move(t));
+            } else {
+                fail("unknown keyword '" + keyword + "'");
+            }
+        }
+        if (current) fail("missing 'end' for workflow '" + current->name + "'");
+        return result;
+    }
 };
 
+// Built-in workflow matching the original Scheduled -> In Progress -> Completed flow
+const char* const kDefaultWorkflowConfig = R"(
+workflow standard
+  state Scheduled Scheduled
+  state InProgress InProgress In Progress
+  state Completed Completed
+  state Cancelled Cancelled
+  state NoShow Cancelled No-Show
+  initial Scheduled
+  next next
+  on Scheduled next -> InProgress
+  on Scheduled noshow -> NoShow
+  on InProgress next -> Completed
+  on * cancel -> Cancelled
+end
+use standard for oil
+use standard for engine
+)";
+
+// Skills a technician holds and a service requires, as bit flags
+constexpr uint32_t kSkillLubrication = 1u << 0;
+constexpr uint32_t kSkillEngine = 1u << 1;
+
+// Parses a comma-separated list such as "oil,engine"; 0 on unknown names
+inline uint32_t parseSkills(string_view text) {
+    uint32_t skills = 0;
+    while (!text.empty()) {
+        size_t comma = text.find(',');
+        string_view name = text.substr(0, comma);
+        if (name == "oil") skills |= kSkillLubrication;
+        else if (name == "engine") skills |= kSkillEngine;
+        else return 0;
+        text = comma == string_view::npos ? string_view() : text.substr(comma + 1);
+    }
+    return skills;
+}
+
 // Base Service class
 class Service {
 protected:
     string serviceType;
     double baseCost;
     vector<string> partsRequired;
+    ServiceKind kind;
+    string description;   // built once at construction
+    uint32_t requiredSkills;
+    int32_t durationMinutes;
 
 public:
-    Service(const string& type, double cost) 
-        : serviceType(type), baseCost(cost) {}
+    Service(string_view type, double cost, ServiceKind kind, string_view description,
+            uint32_t requiredSkills, int32_t durationMinutes)
+        : serviceType(type), baseCost(cost), kind(kind), description(description),
+          requiredSkills(requiredSkills), durationMinutes(durationMinutes) {}
+
+    ServiceKind getKind() const { return kind; }
+    string_view getDescription() const { return description; }
+    uint32_t getRequiredSkills() const { return requiredSkills; }
+    int32_t getDurationMinutes() const { return durationMinutes; }
+
+    const vector<string>& getPartsRequired() const { return partsRequired; }
 
-    virtual double calculateCost() = 0;
-    virtual string getDescription() const = 0;
+    // Heap held by the parts list: the vector buffer plus any non-SSO strings
+    size_t partsBytes() const {
+        size_t bytes = partsRequired.capacity() * sizeof(string);
+        for (const auto& part : partsRequired) {
+            if (part.capacity() > string().capacity()) bytes += part.capacity() + 1;
+        }
+        return bytes;
+    }
+
+    virtual size_t objectBytes() const { return sizeof(Service); }
+    virtual double calculateCost() const = 0;
     virtual ~Service() = default;
 };
 
 // Derived Service classes
 class OilChange : public Service {
 public:
-    OilChange() : Service("Oil Change", 50.0) {
+    OilChange()
+        : Service("Oil Change", 50.0, ServiceKind::OilChange, "Standard Oil Change Service",
+                  kSkillLubrication, 30) {
         partsRequired = {"Oil Filter", "Engine Oil"};
     }
 
-    double calculateCost() override { return baseCost; }
-    string getDescription() const override {
-        return "Standard Oil Change Service";
-    }
+    size_t objectBytes() const override { return sizeof(OilChange); }
+    double calculateCost() const override { return baseCost; }
 };
 
 class EngineRepair : public Service {
 private:
-    string repairType;
+    static constexpr string_view kPrefix = "Engine Repair: ";
 
 public:
-    EngineRepair(const string& type) 
-        : Service("Engine Repair", 200.0), repairType(type) {
+    EngineRepair(string_view type) 
+        : Service("Engine Repair", 200.0, ServiceKind::EngineRepair,
+                  string(kPrefix) + string(type), kSkillEngine, 240) {
         partsRequired = {"Engine Parts", "Lubricants"};
     }
 
-    double calculateCost() override { return baseCost * 1.5; }
-    string getDescription() const override {
-        return "Engine Repair: " + repairType;
-    }
+    // The free-text repair is the tail of the description
+    string_view getRepairType() const { return getDescription().substr(kPrefix.size()); }
+
+    size_t objectBytes() const override { return sizeof(EngineRepair); }
+    double calculateCost() const override { return baseCost * 1.5; }
 };
 
-// Service Appointment class
-class ServiceAppointment {
+// Epoch-based read-copy-update. Readers announce the epoch they started in
+// through a per-thread slot and never block; publishers swap the pointer,
+// advance the epoch and retire the old version to the domain. A retired
+// version is freed when its grace period ends: by the publisher when no
+// reader could hold it, otherwise by the last such reader on its way out,
+// so nothing waits for the cell's next publish. One domain serves every cell.
+//
+// On Linux the fences are asymmetric: readers order their slot updates with
+// compiler barriers only, and writers, which are rare, pay with membarrier,
+// which runs a full barrier on every thread of the process. Without it both
+// sides use seq_cst fences.
+class RcuDomain {
+public:
+    static constexpr size_t kMaxThreads = 256;
+
 private:
-    shared_ptr<Client> client;
-    string vehicleNumber;
-    shared_ptr<Service> service;
-    string scheduledDate;
-    unique_ptr<ServiceState> currentState;
-    ServiceCenter* serviceCenter;
+    struct alignas(64) Slot {
+        atomic<uint64_t> epoch{0};   // 0 while the thread is outside read sections
+        atomic<bool> claimed{false};
+    };
+
+    struct ThreadState {
+        Slot* slot = nullptr;
+        uint32_t depth = 0;
+        ~ThreadState() {
+            if (slot) slot->claimed.store(false, memory_order_release);
+        }
+    };
+
+    struct Retired {
+        const void* value;
+        void (*destroy)(const void*);
+        uint64_t epoch;
+    };
+
+    atomic<uint64_t> globalEpoch{1};
+    array<Slot, kMaxThreads> slots;
+    mutex retiredMutex;
+    vector<Retired> retired;
+    atomic<size_t> pending{0};   // retired.size(), read by leave() without the lock
+    bool asymmetric = false;
+
+    void readerFence() const {
+        if (asymmetric) atomic_signal_fence(memory_order_seq_cst);
+        else atomic_thread_fence(memory_order_seq_cst);
+    }
+
+    void writerFence() const {
+#ifdef __linux__
+        if (asymmetric && syscall(__NR_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0) == 0) return;
+#endif
+        atomic_thread_fence(memory_order_seq_cst);
+    }
+
+    Slot& slotForThread(ThreadState& state) {
+        if (state.slot) return *state.slot;
+        for (auto& slot : slots) {
+            bool expected = false;
+            if (!slot.claimed.load(memory_order_relaxed) &&
+                slot.claimed.compare_exchange_strong(expected, true, memory_order_acquire)) {
+                return *(state.slot = &slot);
+            }
+        }
+        throw runtime_error("RCU reader slots exhausted");
+    }
 
 public:
-    ServiceAppointment(shared_ptr<Client> client, const string& vehicleNum,
-                      shared_ptr<Service> service, const string& date,
-                      ServiceCenter* center)
-        : client(client), vehicleNumber(vehicleNum), service(service),
-          scheduledDate(date), serviceCenter(center) {
-        currentState = make_unique<ScheduledState>();
+    RcuDomain() {
+#ifdef __linux__
+        asymmetric = syscall(__NR_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0) == 0;
+#endif
     }
 
-    void setState(unique_ptr<ServiceState> newState) {
-        currentState = move(newState);
+    static ThreadState& threadState() {
+        static thread_local ThreadState state;
+        return state;
+    }
+
+    // Read sections nest; only the outermost one publishes an epoch. The
+    // fence orders the slot before the caller's load of the cell pointer.
+    void enter() {
+        ThreadState& state = threadState();
+        if (state.depth++ == 0) {
+            slotForThread(state).epoch.store(globalEpoch.load(memory_order_acquire), memory_order_relaxed);
+            readerFence();
+        }
+    }
+
+    // Pairs with retire(): either the publisher sees this slot cleared or
+    // this reader sees the pending version and frees it
+    void leave() {
+        ThreadState& state = threadState();
+        if (--state.depth != 0) return;
+        state.slot->epoch.store(0, memory_order_release);
+        readerFence();
+        if (pending.load(memory_order_relaxed)) reclaim();
+    }
+
+    // Starts a new epoch; versions retired with the returned value are safe
+    // to free once quiescentSince() holds for it
+    uint64_t advance() { return globalEpoch.fetch_add(1, memory_order_seq_cst) + 1; }
+
+    // Takes ownership of a version just unpublished. The first fence makes
+    // the slot of every reader that may hold it visible before it is listed,
+    // so readers reclaiming in leave() see them too; the second pairs with
+    // the fence in leave().
+    template<typename T>
+    void retire(const T* value) {
+        uint64_t epoch = advance();
+        writerFence();
+        {
+            lock_guard<mutex> lock(retiredMutex);
+            retired.push_back({value, [](const void* v) { delete static_cast<const T*>(v); }, epoch});
+            pending.store(retired.size(), memory_order_relaxed);
+        }
+        writerFence();
+        reclaim();
     }
 
-    void progressState() {
-        currentState->nextState(this);
+    // Frees every retired version whose grace period has ended
+    void reclaim() {
+        vector<Retired> done;
+        {
+            lock_guard<mutex> lock(retiredMutex);
+            auto keep = stable_partition(retired.begin(), retired.end(),
+                                         [&](const Retired& r) { return !quiescentSince(r.epoch); });
+            done.assign(keep, retired.end());
+            retired.erase(keep, retired.end());
+            pending.store(retired.size(), memory_order_relaxed);
+        }
+        for (const Retired& r : done) r.destroy(r.value);
     }
 
-    string getStatus() const {
-        return currentState->getStatus();
+    size_t pendingReclaim() const { return pending.load(memory_order_acquire); }
+
+    ~RcuDomain() {
+        for (const Retired& r : retired) r.destroy(r.value);
     }
 
-    shared_ptr<Client> getClient() const { return client; }
-    string getVehicleNumber() const { return vehicleNumber; }
-    shared_ptr<Service> getService() const { return service; }
-    string getScheduledDate() const { return scheduledDate; }
+    bool quiescentSince(uint64_t epoch) const {
+        for (const auto& slot : slots) {
+            uint64_t seen = slot.epoch.load(memory_order_acquire);
+            if (seen && seen < epoch) return false;
+        }
+        return true;
+    }
 };
 
-// Service Center class
-class ServiceCenter {
+inline RcuDomain& rcuDomain() {
+    static RcuDomain domain;
+    return domain;
+}
+
+// Holds one immutable T behind an atomic pointer. read() is wait-free for
+// readers; writers are serialized and hand old versions to the domain.
+template<typename T>
+class RcuCell {
 private:
-    vector<shared_ptr<ServiceAppointment>> appointments;
-    mutex appointmentMutex;
-    condition_variable cv;
-    bool isOpen;
+    atomic<const T*> current;
+    mutex writerMutex;
+
+    // Caller holds writerMutex
+    void replace(unique_ptr<const T> next) {
+        rcuDomain().retire(current.exchange(next.release(), memory_order_seq_cst));
+    }
 
 public:
-    ServiceCenter() : isOpen(true) {}
+    // Pins the version current at construction for the guard's lifetime
+    class ReadGuard {
+    private:
+        const T* value;
 
-    void addAppointment(shared_ptr<Client> client, const string& vehicleNum,
-                       shared_ptr<Service> service, const string& date) {
-        lock_guard<mutex> lock(appointmentMutex);
-        
-        // Check for scheduling conflicts
-        for (const auto& apt : appointments) {
-            if (apt->getScheduledDate() == date && 
-                apt->getVehicleNumber() == vehicleNum) {
-                throw runtime_error("Scheduling conflict: Vehicle already has an appointment on this date");
-            }
+    public:
+        explicit ReadGuard(const atomic<const T*>& cell) {
+            rcuDomain().enter();
+            value = cell.load(memory_order_acquire);
         }
+        ~ReadGuard() { rcuDomain().leave(); }
 
-        auto appointment = make_shared<ServiceAppointment>(
-            client, vehicleNum, service, date, this);
-        appointments.push_back(appointment);
-        
-        // Notify client
-        client->update("Appointment scheduled for " + date);
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        const T& operator*() const { return *value; }
+        const T* operator->() const { return value; }
+    };
+
+    explicit RcuCell(unique_ptr<const T> initial) : current(initial.release()) {}
+
+    ~RcuCell() { delete current.load(); }
+
+    RcuCell(const RcuCell&) = delete;
+    RcuCell& operator=(const RcuCell&) = delete;
+
+    ReadGuard read() const { return ReadGuard(current); }
+
+    void publish(unique_ptr<const T> next) {
+        lock_guard<mutex> lock(writerMutex);
+        replace(move(next));
     }
 
-    void viewAppointments() {
-        lock_guard<mutex> lock(appointmentMutex);
-        for (const auto& apt : appointments) {
-            cout << "\nVehicle: " << apt->getVehicleNumber() 
-                 << "\nClient: " << apt->getClient()->getName()
-                 << "\nService: " << apt->getService()->getDescription()
-                 << "\nDate: " << apt->getScheduledDate()
-                 << "\nStatus: " << apt->getStatus() << endl;
-        }
+    // Publishes edit(current) as the next version. Writers hold the cell,
+    // so the current version cannot be retired while edit reads it.
+    template<typename Edit>
+    void update(Edit&& edit) {
+        lock_guard<mutex> lock(writerMutex);
+        replace(edit(*current.load(memory_order_relaxed)));
+    }
+
+    // As update(), but gives up rather than wait for another writer
+    template<typename Edit>
+    bool tryUpdate(Edit&& edit) {
+        unique_lock<mutex> lock(writerMutex, try_to_lock);
+        if (!lock) return false;
+        replace(edit(*current.load(memory_order_relaxed)));
+        return true;
     }
 };
 
-// State Pattern implementations
-void ScheduledState::nextState(ServiceAppointment* appointment) {
-    appointment->setState(make_unique<InProgressState>());
-}
+// Copy-on-write list of weakly held observers. notify() walks a pinned RCU
+// snapshot without taking a lock; subscribe/unsubscribe copy the list and
+// publish the copy. Observers that no longer exist are skipped and pruned.
+class SubscriberList {
+private:
+    using Snapshot = vector<weak_ptr<ServiceObserver>>;
 
-void InProgressState::nextState(ServiceAppointment* appointment) {
-    appointment->setState(make_unique<CompletedState>());
-}
+    RcuCell<Snapshot> list;
 
-void CompletedState::nextState(ServiceAppointment* appointment) {
-    // Final state - no transition
-}
+    // The live entries of current with edit applied, as the next version
+    template<typename Edit>
+    static unique_ptr<const Snapshot> edited(const Snapshot& current, Edit&& edit) {
+        auto next = make_unique<Snapshot>();
+        next->reserve(current.size() + 1);
+        for (const auto& entry : current) {
+            if (!entry.expired()) next->push_back(entry);
+        }
+        edit(*next);
+        return next;
+    }
 
-int main() {
-    ServiceCenter serviceCenter;
-    int option;
+public:
+    SubscriberList() : list(make_unique<const Snapshot>()) {}
 
-    while (true) {
-        cout << "\nVehicle Service Center Management\n"
-             << "1. Schedule New Appointment\n"
-             << "2. View Appointments\n"
-             << "3. Exit\n"
-             << "Enter your choice: ";
-        
-        cin >> option;
-        cin.ignore();
+    void subscribe(const shared_ptr<ServiceObserver>& observer) {
+        list.update([&](const Snapshot& current) {
+            return edited(current, [&](Snapshot& entries) { entries.push_back(observer); });
+        });
+    }
 
-        try {
-            if (option == 1) {
-                string clientName, contact, vehicleNum, date, serviceType;
-                
-                cout << "Enter client name: ";
-                getline(cin, clientName);
-                cout << "Enter contact number: ";
-                getline(cin, contact);
-                cout << "Enter vehicle number: ";
-                getline(cin, vehicleNum);
-                cout << "Enter appointment date (DD-MM-YYYY): ";
-                getline(cin, date);
-                cout << "Enter service type (oil/engine): ";
-                getline(cin, serviceType);
+    void unsubscribe(const ServiceObserver* observer) {
+        list.update([&](const Snapshot& current) {
+            return edited(current, [&](Snapshot& entries) {
+                entries.erase(remove_if(entries.begin(), entries.end(),
+                                        [&](const weak_ptr<ServiceObserver>& entry) {
+                                            return entry.lock().get() == observer;
+                                        }),
+                              entries.end());
+            });
+        });
+    }
 
-                auto client = make_shared<Client>(clientName, contact);
-                shared_ptr<Service> service;
-                
-                if (serviceType == "oil") {
-                    service = make_shared<OilChange>();
-                } else if (serviceType == "engine") {
-                    cout << "Enter engine repair type: ";
-                    string repairType;
-                    getline(cin, repairType);
-                    service = make_shared<EngineRepair>(repairType);
+    // Calls visit with each live subscriber; returns how many there were
+    template <typename Visit>
+    size_t forEachLive(Visit&& visit) {
+        size_t live = 0, dead = 0;
+        {
+            auto snapshot = list.read();
+            for (const auto& entry : *snapshot) {
+                if (shared_ptr<ServiceObserver> observer = entry.lock()) {
+                    visit(observer);
+                    ++live;
                 } else {
-                    throw invalid_argument("Invalid service type");
+                    ++dead;
                 }
-
-                serviceCenter.addAppointment(client, vehicleNum, service, date);
-                cout << "Appointment scheduled successfully!\n";
-            }
-            else if (option == 2) {
-                serviceCenter.viewAppointments();
             }
-            else if (option == 3) {
+        }
+        // Expiry is permanent, so a writer already holding the list drops
+        // these entries too; notifiers never wait for one another
+        if (dead) {
+            list.tryUpdate([](const Snapshot& current) { return edited(current, [](Snapshot&) {}); });
+        }
+        return live;
+    }
+
+    // Delivers message to every live subscriber; returns how many got it
+    size_t notify(const string& message) {
+        return forEachLive([&](const shared_ptr<ServiceObserver>& observer) { observer->update(message); });
+    }
+
+    size_t size() const { return list.read()->size(); }
+};
+
+// Service defined by the catalog file rather than a subclass
+class CatalogService : public Service {
+private:
+    double multiplier;
+
+public:
+    CatalogService(string_view type, double cost, double multiplier, ServiceKind kind,
+                   string_view description, uint32_t skills, int32_t minutes, vector<string> parts)
+        : Service(type, cost, kind, description, skills, minutes), multiplier(multiplier) {
+        partsRequired = move(parts);
+    }
+
+    size_t objectBytes() const override { return sizeof(CatalogService); }
+    double calculateCost() const override { return baseCost * multiplier; }
+};
+
+// One bookable service type. A non-empty detailPrompt asks for free text
+// that is appended to the description, as engine repairs do.
+struct CatalogEntry {
+    string key;
+    string name;
+    string description;
+    ServiceKind kind = ServiceKind::OilChange;
+    double baseCost = 0;
+    double multiplier = 1.0;
+    uint32_t skills = 0;
+    int32_t minutes = 0;
+    vector<string> parts;
+    string detailPrompt;
+
+    unique_ptr<Service> make(string_view detail = {}) const {
+        string text = description;
+        if (!detailPrompt.empty()) {
+            text += ": ";
+            text += detail;
+        }
+        return make_unique<CatalogService>(name, baseCost, multiplier, kind, text, skills, minutes, parts);
+    }
+};
+
+// Immutable catalog version; replaced whole on reload
+class ServiceCatalog {
+private:
+    vector<CatalogEntry> entries;
+    unordered_map<string, size_t> byKey;
+    uint64_t version;
+
+public:
+    ServiceCatalog(vector<CatalogEntry> entries, uint64_t version)
+        : entries(move(entries)), version(version) {
+        for (size_t i = 0; i < this->entries.size(); ++i) byKey.emplace(this->entries[i].key, i);
+    }
+
+    const CatalogEntry* find(const string& key) const {
+        auto it = byKey.find(key);
+        return it == byKey.end() ? nullptr : &entries[it->second];
+    }
+
+    const vector<CatalogEntry>& all() const { return entries; }
+    uint64_t getVersion() const { return version; }
+
+    // "oil/engine/..." for prompts
+    string keys() const {
+        string text;
+        for (const auto& entry : entries) {
+            if (!text.empty()) text += '/';
+            text += entry.key;
+        }
+        return text;
+    }
+};
+
+// Parses service catalog files:
+//   service <key>
+//     name <words>                  service type shown in reports
+//     description <words>
+//     kind <oil|engine>             selects workflow and dashboard column
+//     cost <base>
+//     multiplier <factor>           optional, default 1
+//     skills <oil,engine>
+//     minutes <duration>
+//     parts <part>[, <part>...]
+//     detail <prompt words>         optional free text appended to the description
+//   end
+// '#' starts a comment.
+class ServiceCatalogLoader {
+private:
+    size_t lineNumber = 0;
+
+    [[noreturn]] void fail(const string& message) const {
+        throw invalid_argument("Service catalog line " + to_string(lineNumber) + ": " + message);
+    }
+
+    static string rest(istringstream& words) {
+        string text;
+        getline(words >> ws, text);
+        while (!text.empty() && isspace(static_cast<unsigned char>(text.back()))) text.pop_back();
+        return text;
+    }
+
+    void finish(CatalogEntry& entry) const {
+        if (entry.name.empty()) entry.name = entry.key;
+        if (entry.description.empty()) fail("service '" + entry.key + "' needs a description");
+        if (entry.baseCost <= 0 || entry.multiplier <= 0) fail("service '" + entry.key + "' needs a positive cost");
+        if (!entry.skills || entry.minutes <= 0) fail("service '" + entry.key + "' needs skills and minutes");
+    }
+
+public:
+    unique_ptr<const ServiceCatalog> load(istream& in, uint64_t version) {
+        vector<CatalogEntry> entries;
+        unique_ptr<CatalogEntry> current;
+        string line;
+
+        while (getline(in, line)) {
+            ++lineNumber;
+            line = line.substr(0, line.find('#'));
+            istringstream words(line);
+            string keyword;
+            if (!(words >> keyword)) continue;
+
+            if (keyword == "service") {
+                if (current) fail("missing 'end' before new service");
+                current = make_unique<CatalogEntry>();
+                if (!(words >> current->key)) fail("service needs a key");
+                for (const auto& entry : entries) {
+                    if (entry.key == current->key) fail("duplicate service '" + current->key + "'");
+                }
+            } else if (!current) {
+                fail("'" + keyword + "' outside a service");
+            } else if (keyword == "end") {
+                finish(*current);
+                entries.push_back(move(*current));
+                current.reset();
+            } else if (keyword == "name") {
+                current->name = rest(words);
+            } else if (keyword == "description") {
+                current->description = rest(words);
+            } else if (keyword == "kind") {
+                string kind;
+                words >> kind;
+                if (kind == "oil") current->kind = ServiceKind::OilChange;
+                else if (kind == "engine") current->kind = ServiceKind::EngineRepair;
+                else fail("expected 'kind <oil|engine>'");
+            } else if (keyword == "cost") {
+                if (!(words >> current->baseCost)) fail("expected 'cost <amount>'");
+            } else if (keyword == "multiplier") {
+                if (!(words >> current->multiplier)) fail("expected 'multiplier <factor>'");
+            } else if (keyword == "skills") {
+                string skills;
+                words >> skills;
+                current->skills = parseSkills(skills);
+                if (!current->skills) fail("unknown skills '" + skills + "'");
+            } else if (keyword == "minutes") {
+                if (!(words >> current->minutes)) fail("expected 'minutes <duration>'");
+            } else if (keyword == "parts") {
+                string part;
+                while (getline(words >> ws, part, ',')) {
+                    while (!part.empty() && isspace(static_cast<unsigned char>(part.back()))) part.pop_back();
+                    if (!part.empty()) current->parts.push_back(part);
+                }
+            } else if (keyword == "detail") {
+                current->detailPrompt = rest(words);
+                if (current->detailPrompt.empty()) fail("expected 'detail <prompt>'");
+            } else {
+                fail("unknown keyword '" + keyword + "'");
+            }
+        }
+        if (current) fail("missing 'end' for service '" + current->key + "'");
+        if (entries.empty()) fail("catalog defines no services");
+        return make_unique<const ServiceCatalog>(move(entries), version);
+    }
+};
+
+// Built-in catalog matching the OilChange and EngineRepair classes
+const char* const kDefaultServiceCatalog = R"(
+service oil
+  name Oil Change
+  description Standard Oil Change Service
+  kind oil
+  cost 50
+  skills oil
+  minutes 30
+  parts Oil Filter, Engine Oil
+end
+service engine
+  name Engine Repair
+  description Engine Repair
+  kind engine
+  cost 200
+  multiplier 1.5
+  skills engine
+  minutes 240
+  parts Engine Parts, Lubricants
+  detail Enter engine repair type
+end
+)";
+
+// Compact per-appointment entry kept in a vehicle's history (16 bytes)
+struct ServiceRecord {
+    int32_t day;
+    uint32_t appointmentId;
+    float cost;
+    ServiceKind service;
+    StateKind state;
+};
+
+// 64-bit string hash (FNV-1a with a splitmix finalizer) for sketches and indexes
+inline uint64_t hashString(string_view text) {
+    uint64_t h = 14695981039346656037ull;
+    for (unsigned char c : text) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    h ^= h >> 30; h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27; h *= 0x94d049bb133111ebull;
+    return h ^ (h >> 31);
+}
+
+// Fixed-capacity run of history records; records follow the header in memory
+struct HistoryChunk {
+    HistoryChunk* next;
+    uint16_t count;
+    uint8_t sizeClass;
+
+    ServiceRecord* records() { return reinterpret_cast<ServiceRecord*>(this + 1); }
+    size_t capacity() const { return size_t(2) << sizeClass; }
+};
+
+// Slab pool handing out history chunks of 2, 4, ... 64 records
+class HistoryChunkPool {
+private:
+    static constexpr size_t kSizeClasses = 6;
+    static constexpr size_t kSlabBytes = 64 * 1024;
+
+    struct FreeNode { FreeNode* next; };
+
+    FreeNode* freeLists[kSizeClasses] = {};
+    vector<unique_ptr<max_align_t[]>> slabs;
+    size_t bytesReserved = 0;
+    size_t chunksInUse = 0;
+
+    static size_t chunkBytes(size_t sizeClass) {
+        return sizeof(HistoryChunk) + (size_t(2) << sizeClass) * sizeof(ServiceRecord);
+    }
+
+    void refill(size_t sizeClass) {
+        size_t bytes = chunkBytes(sizeClass);
+        size_t perSlab = max<size_t>(1, kSlabBytes / bytes);
+        size_t words = (perSlab * bytes + sizeof(max_align_t) - 1) / sizeof(max_align_t);
+        slabs.emplace_back(new max_align_t[words]);
+        bytesReserved += words * sizeof(max_align_t);
+        auto* base = reinterpret_cast<char*>(slabs.back().get());
+        for (size_t i = perSlab; i-- > 0;) {
+            auto* node = reinterpret_cast<FreeNode*>(base + i * bytes);
+            node->next = freeLists[sizeClass];
+            freeLists[sizeClass] = node;
+        }
+    }
+
+public:
+    static constexpr size_t kMaxSizeClass = kSizeClasses - 1;
+
+    HistoryChunk* allocate(size_t sizeClass) {
+        if (!freeLists[sizeClass]) refill(sizeClass);
+        FreeNode* node = freeLists[sizeClass];
+        freeLists[sizeClass] = node->next;
+        ++chunksInUse;
+        auto* chunk = reinterpret_cast<HistoryChunk*>(node);
+        chunk->next = nullptr;
+        chunk->count = 0;
+        chunk->sizeClass = static_cast<uint8_t>(sizeClass);
+        return chunk;
+    }
+
+    void release(HistoryChunk* chunk) {
+        auto* node = reinterpret_cast<FreeNode*>(chunk);
+        node->next = freeLists[chunk->sizeClass];
+        freeLists[chunk->sizeClass] = node;
+        --chunksInUse;
+    }
+
+    size_t reservedBytes() const { return bytesReserved; }
+    size_t liveChunks() const { return chunksInUse; }
+};
+
+// Per-vehicle service history. Each vehicle gets a dense id into a deque of
+// timelines (stable addresses), found through an open-addressing table of
+// 4-byte ids keyed by the inline plate, so no per-vehicle heap node or key
+// string exists. The first two records live inline in the timeline; later
+// ones go to pooled chunks of 4, 8, ... 64 records. A one or two visit
+// vehicle therefore costs one timeline plus a table slot.
+class VehicleHistoryIndex {
+private:
+    static constexpr size_t kInlineRecords = 2;
+    static constexpr uint32_t kEmptySlot = UINT32_MAX;
+
+    struct Timeline {
+        PlateString plate;
+        uint32_t total = 0;
+        ServiceRecord first[kInlineRecords];
+        uint32_t descents = 0;          // appends dated before the previous record
+        HistoryChunk* head = nullptr;   // overflow chunks
+        HistoryChunk* tail = nullptr;
+    };
+
+    deque<Timeline> timelines;
+    vector<uint32_t> slots;             // ids, linear probing, at most half full
+    HistoryChunkPool pool;
+
+    size_t home(string_view plate) const { return hashString(plate) & (slots.size() - 1); }
+
+    const Timeline* find(string_view plate) const {
+        if (slots.empty() || plate.size() > kMaxPlateLength) return nullptr;
+        for (size_t i = home(plate);; i = (i + 1) & (slots.size() - 1)) {
+            if (slots[i] == kEmptySlot) return nullptr;
+            if (timelines[slots[i]].plate.view() == plate) return &timelines[slots[i]];
+        }
+    }
+
+    void grow() {
+        vector<uint32_t> wider(max<size_t>(slots.size() * 2, 64), kEmptySlot);
+        wider.swap(slots);
+        for (uint32_t id = 0; id < timelines.size(); ++id) {
+            size_t i = home(timelines[id].plate.view());
+            while (slots[i] != kEmptySlot) i = (i + 1) & (slots.size() - 1);
+            slots[i] = id;
+        }
+    }
+
+    // Only inserting can allocate; finding an existing timeline never throws
+    Timeline& findOrAdd(string_view plate) {
+        if (const Timeline* found = find(plate)) return const_cast<Timeline&>(*found);
+        if ((timelines.size() + 1) * 2 > slots.size()) grow();
+        size_t i = home(plate);
+        for (; slots[i] != kEmptySlot; i = (i + 1) & (slots.size() - 1)) {
+            if (timelines[slots[i]].plate.view() == plate) return timelines[slots[i]];
+        }
+        slots[i] = static_cast<uint32_t>(timelines.size());
+        timelines.emplace_back();
+        timelines.back().plate = PlateString(plate);
+        return timelines.back();
+    }
+
+public:
+    VehicleHistoryIndex() = default;
+    VehicleHistoryIndex(const VehicleHistoryIndex&) = delete;
+    VehicleHistoryIndex& operator=(const VehicleHistoryIndex&) = delete;
+
+    ~VehicleHistoryIndex() {
+        for (auto& timeline : timelines) {
+            for (HistoryChunk* chunk = timeline.head; chunk;) {
+                HistoryChunk* next = chunk->next;
+                pool.release(chunk);
+                chunk = next;
+            }
+        }
+    }
+
+    // Makes room for one more record of this vehicle, so the next append for
+    // it cannot throw
+    void reserve(string_view vehicleNum) {
+        Timeline& timeline = findOrAdd(vehicleNum);
+        if (timeline.total < kInlineRecords) return;
+        HistoryChunk* tail = timeline.tail;
+        if (tail && tail->count < tail->capacity()) return;
+        size_t sizeClass = tail ? min<size_t>(tail->sizeClass + 1, HistoryChunkPool::kMaxSizeClass) : 1;
+        HistoryChunk* chunk = pool.allocate(sizeClass);
+        if (tail) tail->next = chunk; else timeline.head = chunk;
+        timeline.tail = chunk;
+    }
+
+    // Returned pointer stays valid for the lifetime of the index
+    ServiceRecord* append(string_view vehicleNum, const ServiceRecord& record) {
+        Timeline& timeline = findOrAdd(vehicleNum);
+        if (timeline.total) {
+            const ServiceRecord& last = timeline.total <= kInlineRecords
+                                            ? timeline.first[timeline.total - 1]
+                                            : timeline.tail->records()[timeline.tail->count - 1];
+            timeline.descents += record.day < last.day;
+        }
+        ServiceRecord* slot;
+        if (timeline.total < kInlineRecords) {
+            slot = &timeline.first[timeline.total];
+        } else {
+            HistoryChunk* tail = timeline.tail;
+            if (!tail || tail->count == tail->capacity()) {
+                size_t sizeClass = tail ? min<size_t>(tail->sizeClass + 1, HistoryChunkPool::kMaxSizeClass) : 1;
+                HistoryChunk* chunk = pool.allocate(sizeClass);
+                if (tail) tail->next = chunk; else timeline.head = chunk;
+                timeline.tail = tail = chunk;
+            }
+            slot = tail->records() + tail->count++;
+        }
+        *slot = record;
+        ++timeline.total;
+        return slot;
+    }
+
+    // Visits records in booking order; cost is proportional to the vehicle's history
+    template <typename Visitor>
+    void forEach(string_view vehicleNum, Visitor&& visit) const {
+        const Timeline* timeline = find(vehicleNum);
+        if (!timeline) return;
+        for (size_t i = 0; i < min<size_t>(timeline->total, kInlineRecords); ++i) visit(timeline->first[i]);
+        for (HistoryChunk* chunk = timeline->head; chunk; chunk = chunk->next) {
+            for (size_t i = 0; i < chunk->count; ++i) visit(chunk->records()[i]);
+        }
+    }
+
+    // Full history sorted by service date. Records booked in date order, the
+    // usual case, come back as stored; otherwise the ascending runs left by
+    // out-of-order bookings are merged, O(n log runs).
+    vector<ServiceRecord> timeline(string_view vehicleNum) const {
+        vector<ServiceRecord> result;
+        const Timeline* found = find(vehicleNum);
+        if (!found) return result;
+        result.reserve(found->total);
+        forEach(vehicleNum, [&](const ServiceRecord& record) { result.push_back(record); });
+        if (found->descents == 0) return result;
+
+        auto byDay = [](const ServiceRecord& a, const ServiceRecord& b) { return a.day < b.day; };
+        vector<size_t> runs{0};
+        for (size_t i = 1; i < result.size(); ++i) {
+            if (result[i].day < result[i - 1].day) runs.push_back(i);
+        }
+        runs.push_back(result.size());
+        while (runs.size() > 2) {
+            vector<size_t> merged{0};
+            for (size_t r = 0; r + 2 < runs.size(); r += 2) {
+                inplace_merge(result.begin() + runs[r], result.begin() + runs[r + 1],
+                              result.begin() + runs[r + 2], byDay);
+                merged.push_back(runs[r + 2]);
+            }
+            if (runs.size() % 2 == 0) merged.push_back(runs.back());
+            runs.swap(merged);
+        }
+        return result;
+    }
+
+    size_t vehicleCount() const { return timelines.size(); }
+
+    // Timelines, probe table and overflow chunks
+    size_t bytesUsed() const {
+        return timelines.size() * sizeof(Timeline) + slots.capacity() * sizeof(uint32_t) + pool.reservedBytes();
+    }
+};
+
+// A vehicle whose next oil change has come due
+struct DueNotice {
+    string vehicleNumber;
+    int32_t dueDay;
+    Client* client;
+};
+
+// Next-due-date index for oil changes. Each completion pushes a fresh heap
+// entry and bumps the vehicle's generation, so superseded entries are dropped
+// lazily when they reach the top and the daily scan only touches due vehicles.
+class DueServiceIndex {
+private:
+    struct HeapEntry {
+        int32_t dueDay;
+        uint32_t generation;
+        string vehicleNumber;
+
+        bool operator>(const HeapEntry& other) const { return dueDay > other.dueDay; }
+    };
+
+    struct VehicleDue {
+        int32_t lastServiceDay;
+        uint32_t generation;
+        Client* client;
+    };
+
+    priority_queue<HeapEntry, vector<HeapEntry>, greater<HeapEntry>> heap;
+    unordered_map<string, VehicleDue> vehicles;
+    int32_t intervalDays;
+
+public:
+    explicit DueServiceIndex(int32_t intervalDays = 180) : intervalDays(intervalDays) {}
+
+    void recordCompletion(const string& vehicleNum, int32_t serviceDay, Client* client) {
+        if (serviceDay == kInvalidDay) return;
+        auto [it, inserted] = vehicles.try_emplace(vehicleNum, VehicleDue{serviceDay, 0, client});
+        if (!inserted) {
+            if (it->second.lastServiceDay >= serviceDay) return;
+            it->second = VehicleDue{serviceDay, it->second.generation + 1, client};
+        }
+        uint32_t generation = it->second.generation;
+        heap.push(HeapEntry{serviceDay + intervalDays, generation, vehicleNum});
+    }
+
+    // Removes and returns every vehicle due on or before today
+    vector<DueNotice> popDue(int32_t today) {
+        vector<DueNotice> due;
+        while (!heap.empty() && heap.top().dueDay <= today) {
+            HeapEntry entry = heap.top();
+            heap.pop();
+            auto it = vehicles.find(entry.vehicleNumber);
+            if (it == vehicles.end() || it->second.generation != entry.generation) continue;
+            due.push_back(DueNotice{move(entry.vehicleNumber), entry.dueDay, it->second.client});
+            vehicles.erase(it);
+        }
+        return due;
+    }
+
+    size_t trackedVehicles() const { return vehicles.size(); }
+};
+
+// Gives every thread its own instance of T. Writers only touch their own
+// shard behind an uncontended flag; readers drain all shards when needed.
+template <typename T>
+class ThreadShards {
+private:
+    struct Shard {
+        atomic_flag busy = ATOMIC_FLAG_INIT;
+        T value;
+    };
+
+    static inline atomic<uint64_t> nextInstanceId{1};
+
+    uint64_t instanceId = nextInstanceId.fetch_add(1, memory_order_relaxed);
+    mutex registryMutex;   // taken once per thread, on first use
+    vector<unique_ptr<Shard>> shards;
+
+    Shard& localShard() {
+        // Instance ids are never reused, so stale cache entries are harmless
+        thread_local unordered_map<uint64_t, void*> cache;
+        thread_local uint64_t lastId = 0;
+        thread_local void* lastShard = nullptr;
+        if (lastId == instanceId) return *static_cast<Shard*>(lastShard);
+
+        void*& slot = cache[instanceId];
+        if (!slot) {
+            lock_guard<mutex> lock(registryMutex);
+            shards.push_back(make_unique<Shard>());
+            slot = shards.back().get();
+        }
+        lastId = instanceId;
+        lastShard = slot;
+        return *static_cast<Shard*>(slot);
+    }
+
+    static void acquire(Shard& shard) {
+        while (shard.busy.test_and_set(memory_order_acquire)) this_thread::yield();
+    }
+
+public:
+    template <typename Fn>
+    void update(Fn&& fn) {
+        Shard& shard = localShard();
+        acquire(shard);
+        fn(shard.value);
+        shard.busy.clear(memory_order_release);
+    }
+
+    // Visits every thread's instance; fn may move data out of it
+    template <typename Fn>
+    void forEach(Fn&& fn) {
+        lock_guard<mutex> lock(registryMutex);
+        for (auto& shard : shards) {
+            acquire(*shard);
+            fn(shard->value);
+            shard->busy.clear(memory_order_release);
+        }
+    }
+};
+
+// Booking count and revenue for one date x service type x state cell
+struct AggregateCell {
+    int64_t count = 0;
+    double revenue = 0.0;
+};
+
+using DayAggregates = array<AggregateCell, kServiceKindCount * kStateKindCount>;
+
+inline size_t aggregateSlot(ServiceKind service, StateKind state) {
+    return static_cast<size_t>(service) * kStateKindCount + static_cast<size_t>(state);
+}
+
+// Materialized dashboard tables. Bookings and transitions update the per-day
+// cells in place (callers hold the book lock), so a query costs only the
+// size of its result, not the size of the book.
+class AggregateTables {
+private:
+    map<int32_t, DayAggregates> days;
+
+public:
+    void record(int32_t day, ServiceKind service, StateKind state, int64_t count, double revenue) {
+        AggregateCell& cell = days[day][aggregateSlot(service, state)];
+        cell.count += count;
+        cell.revenue += revenue;
+    }
+
+    void transition(int32_t day, ServiceKind service, StateKind from, StateKind to, double revenue) {
+        record(day, service, from, -1, -revenue);
+        record(day, service, to, 1, revenue);
+    }
+
+    // Days in [fromDay, toDay] that have any bookings
+    vector<pair<int32_t, DayAggregates>> query(int32_t fromDay, int32_t toDay) const {
+        vector<pair<int32_t, DayAggregates>> result;
+        for (auto it = days.lower_bound(fromDay); it != days.end() && it->first <= toDay; ++it) {
+            result.emplace_back(it->first, it->second);
+        }
+        return result;
+    }
+};
+
+// Space-Saving heavy hitters over at most `capacity` counters. Any key whose
+// true weight exceeds W/capacity (W = total weight seen) is guaranteed to be
+// tracked, and each reported count overestimates the truth by at most `error`
+// (itself bounded by W/capacity). Merging two summaries keeps the same bound
+// over the combined stream. Keys are 64-bit ids (client ids or precomputed
+// hashes). Counters form a min-heap on count, indexed by a fixed open-
+// addressing table, so an update is O(log capacity) and never allocates.
+class SpaceSavingTopK {
+public:
+    struct Counter {
+        uint64_t key;
+        double count;
+        double error;
+    };
+
+private:
+    static constexpr uint32_t kEmpty = UINT32_MAX;
+
+    size_t capacity;
+    vector<Counter> heap;      // min-heap on count
+    vector<uint32_t> slots;    // key -> heap position, linear probing
+    size_t mask;
+
+    size_t home(uint64_t key) const { return (key * 0x9e3779b97f4a7c15ull >> 32) & mask; }
+
+    // Slot holding key, or the empty slot where it would go
+    size_t findSlot(uint64_t key) const {
+        size_t i = home(key);
+        while (slots[i] != kEmpty && heap[slots[i]].key != key) i = (i + 1) & mask;
+        return i;
+    }
+
+    // Backward-shift deletion keeps probe chains intact without tombstones
+    void eraseSlot(size_t i) {
+        slots[i] = kEmpty;
+        for (size_t j = (i + 1) & mask; slots[j] != kEmpty; j = (j + 1) & mask) {
+            size_t h = home(heap[slots[j]].key);
+            if (((j - h) & mask) >= ((j - i) & mask)) {
+                slots[i] = slots[j];
+                slots[j] = kEmpty;
+                i = j;
+            }
+        }
+    }
+
+    void swapEntries(size_t a, size_t b) {
+        size_t slotA = findSlot(heap[a].key), slotB = findSlot(heap[b].key);
+        swap(heap[a], heap[b]);
+        slots[slotA] = static_cast<uint32_t>(b);
+        slots[slotB] = static_cast<uint32_t>(a);
+    }
+
+    void siftUp(size_t pos) {
+        while (pos > 0 && heap[(pos - 1) / 2].count > heap[pos].count) {
+            swapEntries(pos, (pos - 1) / 2);
+            pos = (pos - 1) / 2;
+        }
+    }
+
+    void siftDown(size_t pos) {
+        for (;;) {
+            size_t smallest = pos, left = 2 * pos + 1, right = left + 1;
+            if (left < heap.size() && heap[left].count < heap[smallest].count) smallest = left;
+            if (right < heap.size() && heap[right].count < heap[smallest].count) smallest = right;
+            if (smallest == pos) return;
+            swapEntries(pos, smallest);
+            pos = smallest;
+        }
+    }
+
+    double floorCount() const { return heap.size() < capacity ? 0.0 : heap[0].count; }
+
+public:
+    explicit SpaceSavingTopK(size_t capacity = 64) : capacity(max<size_t>(capacity, 1)) {
+        size_t size = 1;
+        while (size < 2 * this->capacity) size <<= 1;
+        slots.assign(size, kEmpty);
+        mask = size - 1;
+        heap.reserve(this->capacity);
+    }
+
+    void add(uint64_t key, double weight = 1.0) {
+        size_t slot = findSlot(key);
+        if (slots[slot] != kEmpty) {
+            size_t pos = slots[slot];
+            heap[pos].count += weight;
+            siftDown(pos);
+            return;
+        }
+        if (heap.size() < capacity) {
+            heap.push_back(Counter{key, weight, 0.0});
+            slots[slot] = static_cast<uint32_t>(heap.size() - 1);
+            siftUp(heap.size() - 1);
+            return;
+        }
+        // The newcomer takes over the minimum counter and inherits its count as error
+        double floor = heap[0].count;
+        eraseSlot(findSlot(heap[0].key));
+        heap[0] = Counter{key, floor + weight, floor};
+        slots[findSlot(key)] = 0;
+        siftDown(0);
+    }
+
+    void merge(const SpaceSavingTopK& other) {
+        double ownFloor = floorCount(), otherFloor = other.floorCount();
+        unordered_map<uint64_t, Counter> combined;
+        for (const auto& c : heap) combined[c.key] = Counter{c.key, c.count + otherFloor, c.error + otherFloor};
+        for (const auto& c : other.heap) {
+            auto it = combined.find(c.key);
+            if (it != combined.end()) {
+                it->second.count += c.count - otherFloor;
+                it->second.error += c.error - otherFloor;
+            } else {
+                combined[c.key] = Counter{c.key, c.count + ownFloor, c.error + ownFloor};
+            }
+        }
+        heap.clear();
+        for (auto& entry : combined) heap.push_back(entry.second);
+        sort(heap.begin(), heap.end(), [](const Counter& a, const Counter& b) { return a.count > b.count; });
+        if (heap.size() > capacity) heap.resize(capacity);
+        // Descending order reversed is ascending, which is a valid min-heap
+        reverse(heap.begin(), heap.end());
+        fill(slots.begin(), slots.end(), kEmpty);
+        for (size_t i = 0; i < heap.size(); ++i) slots[findSlot(heap[i].key)] = static_cast<uint32_t>(i);
+    }
+
+    vector<Counter> top(size_t n) const {
+        vector<Counter> result(heap);
+        sort(result.begin(), result.end(),
+             [](const Counter& a, const Counter& b) { return a.count > b.count; });
+        if (result.size() > n) result.resize(n);
+        return result;
+    }
+};
+
+// HyperLogLog distinct counter with 2^12 one-byte registers (4 KB). The
+// relative standard error is 1.04 / sqrt(4096), about 1.6%; small
+// cardinalities fall back to linear counting. Merge is a register-wise max.
+class HyperLogLog {
+private:
+    static constexpr int kPrecision = 12;
+    static constexpr size_t kRegisters = size_t(1) << kPrecision;
+    array<uint8_t, kRegisters> registers{};
+
+public:
+    void add(uint64_t hash) {
+        size_t slot = hash >> (64 - kPrecision);
+        uint64_t rest = (hash << kPrecision) | (uint64_t(1) << (kPrecision - 1));
+        uint8_t rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+        if (rank > registers[slot]) registers[slot] = rank;
+    }
+
+    void merge(const HyperLogLog& other) {
+        for (size_t i = 0; i < kRegisters; ++i) {
+            registers[i] = max(registers[i], other.registers[i]);
+        }
+    }
+
+    double estimate() const {
+        double sum = 0.0;
+        size_t zeros = 0;
+        for (uint8_t r : registers) {
+            sum += ldexp(1.0, -r);
+            zeros += r == 0;
+        }
+        const double m = static_cast<double>(kRegisters);
+        double raw = (0.7213 / (1.0 + 1.079 / m)) * m * m / sum;
+        if (raw <= 2.5 * m && zeros > 0) return m * log(m / static_cast<double>(zeros));
+        return raw;
+    }
+};
+
+// Streaming ops-board state; instances merge, e.g. to combine branches
+struct OpsSketches {
+    SpaceSavingTopK bookingsByClient;
+    SpaceSavingTopK spendByClient;
+    map<int32_t, HyperLogLog> vehiclesByMonth;   // keyed by year * 12 + month - 1
+
+    void merge(const OpsSketches& other) {
+        bookingsByClient.merge(other.bookingsByClient);
+        spendByClient.merge(other.spendByClient);
+        for (const auto& month : other.vehiclesByMonth) vehiclesByMonth[month.first].merge(month.second);
+    }
+};
+
+inline int32_t monthKey(int32_t day) {
+    int year, month, dayOfMonth;
+    civilFromDays(day, year, month, dayOfMonth);
+    return year * 12 + month - 1;
+}
+
+// Radix tree over plate numbers. Every node keeps the highest visit count in
+// its subtree, so a prefix query walks best-first and stops after `limit`
+// results instead of enumerating everything under a short prefix.
+class PlateRadixTree {
+public:
+    struct Match {
+        string plate;
+        uint32_t visits;
+    };
+
+private:
+    struct Node {
+        string label;
+        vector<unique_ptr<Node>> children;   // sorted by first label character
+        uint32_t visits = 0;                 // non-zero marks a stored plate
+        uint32_t bestBelow = 0;
+    };
+
+    Node root;
+    size_t plateCount = 0;
+    vector<Node*> path;   // addVisit scratch, kept to avoid an allocation per visit
+
+    static size_t commonPrefix(const string& a, size_t offset, const string& b) {
+        size_t n = 0;
+        while (n < b.size() && offset + n < a.size() && a[offset + n] == b[n]) ++n;
+        return n;
+    }
+
+    static unique_ptr<Node>* findChild(Node& node, char c) {
+        auto it = lower_bound(node.children.begin(), node.children.end(), c,
+                              [](const unique_ptr<Node>& child, char ch) { return child->label[0] < ch; });
+        return it != node.children.end() && (*it)->label[0] == c ? &*it : nullptr;
+    }
+
+    static void insertChild(Node& node, unique_ptr<Node> child) {
+        auto it = lower_bound(node.children.begin(), node.children.end(), child->label[0],
+                              [](const unique_ptr<Node>& c, char ch) { return c->label[0] < ch; });
+        node.children.insert(it, move(child));
+    }
+
+public:
+    // Records one more visit for the plate and returns its total
+    uint32_t addVisit(const string& plate) {
+        if (plate.empty()) return 0;
+        path.assign(1, &root);
+        Node* node = &root;
+        size_t offset = 0;
+        while (offset < plate.size()) {
+            unique_ptr<Node>* slot = findChild(*node, plate[offset]);
+            if (!slot) {
+                auto leaf = make_unique<Node>();
+                leaf->label = plate.substr(offset);
+                Node* raw = leaf.get();
+                insertChild(*node, move(leaf));
+                node = raw;
+                offset = plate.size();
+                path.push_back(node);
+                break;
+            }
+            Node* child = slot->get();
+            size_t shared = commonPrefix(plate, offset, child->label);
+            if (shared < child->label.size()) {
+                // Split the edge at the point where the plates diverge
+                auto middle = make_unique<Node>();
+                middle->label = child->label.substr(0, shared);
+                middle->bestBelow = child->bestBelow;
+                child->label.erase(0, shared);
+                middle->children.push_back(move(*slot));
+                *slot = move(middle);
+                child = slot->get();
+            }
+            node = child;
+            offset += shared;
+            path.push_back(node);
+        }
+        if (node->visits == 0) ++plateCount;
+        uint32_t visits = ++node->visits;
+        for (Node* n : path) n->bestBelow = max(n->bestBelow, visits);
+        return visits;
+    }
+
+    // Plates starting with prefix, most visited first
+    vector<Match> findPrefix(const string& prefix, size_t limit) const {
+        vector<Match> result;
+        const Node* node = &root;
+        string path;
+        size_t offset = 0;
+        while (offset < prefix.size()) {
+            const Node* next = nullptr;
+            for (const auto& child : node->children) {
+                if (child->label[0] == prefix[offset]) { next = child.get(); break; }
+            }
+            if (!next) return result;
+            size_t shared = commonPrefix(prefix, offset, next->label);
+            if (shared < next->label.size() && offset + shared < prefix.size()) return result;
+            path += next->label;
+            offset += shared;
+            node = next;
+        }
+
+        struct Candidate {
+            uint32_t score;
+            const Node* node;    // null for a finished plate
+            string text;
+            bool operator<(const Candidate& other) const { return score < other.score; }
+        };
+        priority_queue<Candidate> frontier;
+        frontier.push(Candidate{node->bestBelow, node, path});
+        while (!frontier.empty() && result.size() < limit) {
+            Candidate top = frontier.top();
+            frontier.pop();
+            if (!top.node) {
+                result.push_back(Match{move(top.text), top.score});
+                continue;
+            }
+            if (top.node->visits) frontier.push(Candidate{top.node->visits, nullptr, top.text});
+            for (const auto& child : top.node->children) {
+                frontier.push(Candidate{child->bestBelow, child.get(), top.text + child->label});
+            }
+        }
+        return result;
+    }
+
+    size_t size() const { return plateCount; }
+};
+
+// Trigram index for fuzzy client-name lookup, ranked by Dice similarity
+class TrigramIndex {
+public:
+    struct Match {
+        string name;
+        double score;
+    };
+
+private:
+    vector<string> names;
+    vector<uint32_t> gramOffsets{0};    // name i owns grams[gramOffsets[i], gramOffsets[i + 1])
+    vector<uint32_t> grams;
+    unordered_map<string, uint32_t> nameIds;
+    unordered_map<uint32_t, vector<uint32_t>> postings;
+
+    static string normalize(string_view text) {
+        string out = "$";
+        for (unsigned char c : text) {
+            if (isalnum(c)) out += static_cast<char>(tolower(c));
+            else if (out.back() != '$') out += '$';
+        }
+        if (out.back() != '$') out += '$';
+        return out;
+    }
+
+    static vector<uint32_t> trigrams(const string& normalized) {
+        vector<uint32_t> result;
+        for (size_t i = 0; i + 3 <= normalized.size(); ++i) {
+            result.push_back((uint32_t(uint8_t(normalized[i])) << 16) |
+                             (uint32_t(uint8_t(normalized[i + 1])) << 8) |
+                             uint32_t(uint8_t(normalized[i + 2])));
+        }
+        sort(result.begin(), result.end());
+        result.erase(unique(result.begin(), result.end()), result.end());
+        return result;
+    }
+
+public:
+    void add(string_view name) {
+        string key = normalize(name);
+        if (key.size() < 3 || nameIds.count(key)) return;
+        uint32_t id = static_cast<uint32_t>(names.size());
+        auto nameGrams = trigrams(key);
+        nameIds.emplace(key, id);
+        names.emplace_back(name);
+        grams.insert(grams.end(), nameGrams.begin(), nameGrams.end());
+        gramOffsets.push_back(static_cast<uint32_t>(grams.size()));
+        for (uint32_t gram : nameGrams) postings[gram].push_back(id);
+    }
+
+    // Counts shared trigrams per name in a reusable per-thread scratch array,
+    // so a query costs the total length of its posting lists
+    vector<Match> search(const string& query, size_t limit, double minScore = 0.3) const {
+        vector<Match> result;
+        auto queryGrams = trigrams(normalize(query));
+        if (queryGrams.empty()) return result;
+        if (queryGrams.size() > UINT8_MAX) queryGrams.resize(UINT8_MAX);
+
+        thread_local vector<uint8_t> shared;
+        thread_local vector<uint32_t> touched;
+        if (shared.size() < names.size()) shared.resize(names.size());
+        touched.clear();
+        for (uint32_t gram : queryGrams) {
+            auto it = postings.find(gram);
+            if (it == postings.end()) continue;
+            for (uint32_t id : it->second) {
+                if (shared[id]++ == 0) touched.push_back(id);
+            }
+        }
+
+        size_t q = queryGrams.size();
+        for (uint32_t id : touched) {
+            size_t count = gramOffsets[id + 1] - gramOffsets[id];
+            double score = 2.0 * shared[id] / (q + count);
+            if (score >= minScore) result.push_back(Match{names[id], score});
+            shared[id] = 0;
+        }
+        size_t keep = min(limit, result.size());
+        partial_sort(result.begin(), result.begin() + keep, result.end(),
+                     [](const Match& a, const Match& b) { return a.score > b.score; });
+        result.resize(keep);
+        return result;
+    }
+};
+
+// Front-desk search over plates (by prefix) and client names (fuzzy)
+class SearchIndex {
+private:
+    PlateRadixTree plates;
+    TrigramIndex clientNames;
+    vector<bool> clientIndexed;   // by client id; a name is indexed on its first booking
+
+    static string plateKey(const string& plate) {
+        string key(plate.size(), '\0');
+        key.resize(normalizePlateInto(plate, &key[0]));
+        return key;
+    }
+
+public:
+    void addBooking(const string& vehicleNum, uint32_t clientId, string_view clientName) {
+        if (clientId >= clientIndexed.size()) clientIndexed.resize(max<size_t>(clientId + 1, clientIndexed.size() * 2));
+        if (!clientIndexed[clientId]) clientNames.add(clientName);
+        plates.addVisit(plateKey(vehicleNum));
+        clientIndexed[clientId] = true;
+    }
+
+    vector<PlateRadixTree::Match> findPlates(const string& prefix, size_t limit = 10) const {
+        return plates.findPrefix(plateKey(prefix), limit);
+    }
+
+    vector<TrigramIndex::Match> findClients(const string& query, size_t limit = 10) const {
+        return clientNames.search(query, limit);
+    }
+};
+
+// One completed span; names are string literals
+struct TraceEvent {
+    const char* name;
+    int64_t startNs;
+    int64_t durationNs;
+};
+
+// Fixed-size per-thread ring; the oldest spans are overwritten
+struct TraceRing {
+    static constexpr size_t kCapacity = 8192;
+    vector<TraceEvent> events;
+    uint64_t written = 0;
+    uint32_t threadId = 0;
+};
+
+// Span recorder with per-thread ring buffers and Chrome/Perfetto JSON export.
+// While disabled, a span costs one relaxed atomic load.
+class Tracer {
+private:
+    atomic<bool> enabled{false};
+    atomic<uint32_t> nextThreadId{1};
+    ThreadShards<TraceRing> rings;
+    chrono::steady_clock::time_point epoch = chrono::steady_clock::now();
+
+public:
+    bool isEnabled() const { return enabled.load(memory_order_relaxed); }
+    void setEnabled(bool on) { enabled.store(on, memory_order_relaxed); }
+
+    int64_t now() const {
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - epoch).count();
+    }
+
+    void record(const char* name, int64_t startNs, int64_t endNs) {
+        rings.update([&](TraceRing& ring) {
+            if (ring.events.empty()) {
+                ring.events.resize(TraceRing::kCapacity);
+                ring.threadId = nextThreadId.fetch_add(1, memory_order_relaxed);
+            }
+            ring.events[ring.written++ % TraceRing::kCapacity] = TraceEvent{name, startNs, endNs - startNs};
+        });
+    }
+
+    // Writes every buffered span in Chrome trace-event format; returns the span count
+    size_t exportChromeJson(ostream& out) {
+        size_t count = 0;
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        rings.forEach([&](TraceRing& ring) {
+            uint64_t first = ring.written > TraceRing::kCapacity ? ring.written - TraceRing::kCapacity : 0;
+            for (uint64_t i = first; i < ring.written; ++i) {
+                const TraceEvent& event = ring.events[i % TraceRing::kCapacity];
+                out << (count++ ? ",\n" : "\n") << "{\"name\":\"" << event.name
+                    << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring.threadId
+                    << ",\"ts\":" << event.startNs / 1000.0 << ",\"dur\":" << event.durationNs / 1000.0 << "}";
+            }
+        });
+        out << "\n]}\n";
+        return count;
+    }
+
+    void clear() {
+        rings.forEach([](TraceRing& ring) { ring.written = 0; });
+    }
+};
+
+inline Tracer& tracer() {
+    static Tracer instance;
+    return instance;
+}
+
+// Scoped span: records its lifetime when tracing was on at construction
+class TraceSpan {
+private:
+    const char* name;
+    int64_t startNs;
+
+public:
+    explicit TraceSpan(const char* name)
+        : name(name), startNs(tracer().isEnabled() ? tracer().now() : -1) {}
+    ~TraceSpan() {
+        if (startNs >= 0) tracer().record(name, startNs, tracer().now());
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
+
+// Hot paths whose heap traffic is profiled
+enum class AllocationSite : uint8_t { AddAppointment, ProgressState, ListedRecord };
+constexpr size_t kAllocationSiteCount = 3;
+
+inline const char* allocationSiteName(AllocationSite site) {
+    switch (site) {
+    case AllocationSite::AddAppointment: return "addAppointment";
+    case AllocationSite::ProgressState: return "progressState";
+    case AllocationSite::ListedRecord: return "listed record";
+    }
+    return "unknown";
+}
+
+struct AllocationCounter {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+
+// Counter of the innermost AllocationScope on this thread; null outside scopes
+static thread_local AllocationCounter* activeAllocationCounter = nullptr;
+
+// Process-wide totals per site; collection is off until enabled
+class AllocationProfile {
+public:
+    struct Totals {
+        uint64_t operations;
+        uint64_t allocations;
+        uint64_t bytes;
+    };
+
+private:
+    struct Site {
+        atomic<uint64_t> operations{0};
+        atomic<uint64_t> allocations{0};
+        atomic<uint64_t> bytes{0};
+    };
+    atomic<bool> enabled{false};
+    array<Site, kAllocationSiteCount> sites;
+
+public:
+    bool isEnabled() const { return enabled.load(memory_order_relaxed); }
+    void setEnabled(bool on) { enabled.store(on, memory_order_relaxed); }
+
+    void record(AllocationSite site, uint64_t operations, const AllocationCounter& counter) {
+        Site& s = sites[static_cast<size_t>(site)];
+        s.operations.fetch_add(operations, memory_order_relaxed);
+        s.allocations.fetch_add(counter.allocations, memory_order_relaxed);
+        s.bytes.fetch_add(counter.bytes, memory_order_relaxed);
+    }
+
+    Totals totals(AllocationSite site) const {
+        const Site& s = sites[static_cast<size_t>(site)];
+        return {s.operations.load(memory_order_relaxed), s.allocations.load(memory_order_relaxed),
+                s.bytes.load(memory_order_relaxed)};
+    }
+
+    void reset() {
+        for (auto& s : sites) {
+            s.operations.store(0, memory_order_relaxed);
+            s.allocations.store(0, memory_order_relaxed);
+            s.bytes.store(0, memory_order_relaxed);
+        }
+    }
+};
+
+inline AllocationProfile& allocationProfile() {
+    static AllocationProfile instance;
+    return instance;
+}
+
+// Attributes the calling thread's allocations to a site for its lifetime.
+// Nested scopes count toward their enclosing scope as well.
+class AllocationScope {
+private:
+    AllocationSite site;
+    uint64_t operations = 1;
+    AllocationCounter counter;
+    AllocationCounter* parent = nullptr;
+    bool active;
+
+public:
+    explicit AllocationScope(AllocationSite site)
+        : site(site), active(allocationProfile().isEnabled()) {
+        if (!active) return;
+        parent = activeAllocationCounter;
+        activeAllocationCounter = &counter;
+    }
+
+    ~AllocationScope() {
+        if (!active) return;
+        activeAllocationCounter = parent;
+        if (parent) {
+            parent->allocations += counter.allocations;
+            parent->bytes += counter.bytes;
+        }
+        allocationProfile().record(site, operations, counter);
+    }
+
+    // For scopes covering a batch, e.g. one listing of many records
+    void setOperations(uint64_t count) { operations = count; }
+
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+};
+
+// Global new/delete feeding AllocationScope. Outside a scope the only extra
+// cost is one thread-local load; build with -DNO_ALLOCATION_HOOKS to keep the
+// library's operators.
+#ifndef NO_ALLOCATION_HOOKS
+inline void countAllocation(size_t bytes) {
+    if (AllocationCounter* counter = activeAllocationCounter) {
+        ++counter->allocations;
+        counter->bytes += bytes;
+    }
+}
+
+void* operator new(size_t bytes) {
+    countAllocation(bytes);
+    if (void* p = malloc(bytes ? bytes : 1)) return p;
+    throw bad_alloc();
+}
+
+// pmr's default resource allocates through the aligned overloads
+void* operator new(size_t bytes, align_val_t alignment) {
+    countAllocation(bytes);
+    size_t align = max(static_cast<size_t>(alignment), sizeof(void*));
+    if (void* p = aligned_alloc(align, (max<size_t>(bytes, 1) + align - 1) / align * align)) return p;
+    throw bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+[[gnu::noinline]] void operator delete(void* p, align_val_t) noexcept { free(p); }
+void operator delete(void* p, size_t, align_val_t alignment) noexcept { operator delete(p, alignment); }
+#endif
+
+// Business calendar: regular weekly closures plus per-year bitmaps of
+// holidays and reduced-capacity days. Bit i of a year's words is day-of-year
+// i, so an open-day check is one bit test and the next-open search covers 64
+// days per word with a count-trailing-zeros. Weekly closures are not stored
+// per year; a precomputed 64-day pattern per starting weekday is OR-ed in.
+class BusinessCalendar {
+private:
+    static constexpr size_t kWordsPerYear = 6;   // 384 bits >= 366 days
+    static constexpr int32_t kSearchHorizon = 2 * 366;
+
+    struct YearBits {
+        array<uint64_t, kWordsPerYear> closed{};
+        array<uint64_t, kWordsPerYear> reduced{};
+    };
+
+    uint8_t weeklyClosures = 0;                  // bit w: weekday w, 0 = Sunday
+    array<uint64_t, 7> weeklyPattern{};          // closures for 64 days from weekday w
+    unordered_map<int, YearBits> years;          // only years with exceptions
+    unordered_map<int32_t, string> dayNames;     // holiday and reduced-day names
+    uint32_t reducedCapacity = 0;                // 0: half the regular capacity
+
+    struct Position {
+        int year;
+        int32_t yearStart;
+        int32_t yearLength;
+        size_t word;
+        unsigned bit;
+    };
+
+    static Position locate(int32_t day) {
+        int year, month, dayOfMonth;
+        civilFromDays(day, year, month, dayOfMonth);
+        int32_t start = daysFromCivil(year, 1, 1);
+        int32_t offset = day - start;
+        return {year, start, daysFromCivil(year + 1, 1, 1) - start, size_t(offset / 64), unsigned(offset % 64)};
+    }
+
+    const YearBits* bitsFor(int year) const {
+        auto it = years.find(year);
+        return it == years.end() ? nullptr : &it->second;
+    }
+
+    // Closed days among the 64 starting at the given word of a year
+    uint64_t closedWord(const Position& at, const YearBits* bits) const {
+        uint64_t closed = weeklyPattern[weekday(at.yearStart + int32_t(at.word * 64))];
+        if (bits) closed |= bits->closed[at.word];
+        int32_t remaining = at.yearLength - int32_t(at.word * 64);
+        if (remaining < 64) closed |= ~0ULL << remaining;   // past the year's end
+        return closed;
+    }
+
+public:
+    static const char* const kWeekdayNames[7];
+
+    static int weekday(int32_t day) { return int(((day % 7) + 11) % 7); }   // 01-01-1970 was a Thursday
+
+    void setWeeklyClosures(uint8_t weekdays) {
+        weeklyClosures = weekdays & 0x7f;
+        for (int start = 0; start < 7; ++start) {
+            uint64_t pattern = 0;
+            for (int i = 0; i < 64; ++i) {
+                if (weeklyClosures >> ((start + i) % 7) & 1) pattern |= 1ULL << i;
+            }
+            weeklyPattern[start] = pattern;
+        }
+    }
+
+    void addHoliday(int32_t day, string name) {
+        Position at = locate(day);
+        years[at.year].closed[at.word] |= 1ULL << at.bit;
+        if (!name.empty()) dayNames[day] = move(name);
+    }
+
+    void addReducedDay(int32_t day, string name) {
+        Position at = locate(day);
+        years[at.year].reduced[at.word] |= 1ULL << at.bit;
+        if (!name.empty()) dayNames[day] = move(name);
+    }
+
+    void setReducedCapacity(uint32_t capacity) { reducedCapacity = capacity; }
+
+    bool isClosed(int32_t day) const {
+        if (weeklyClosures >> weekday(day) & 1) return true;
+        Position at = locate(day);
+        const YearBits* bits = bitsFor(at.year);
+        return bits && (bits->closed[at.word] >> at.bit & 1);
+    }
+
+    bool isReduced(int32_t day) const {
+        Position at = locate(day);
+        const YearBits* bits = bitsFor(at.year);
+        return bits && (bits->reduced[at.word] >> at.bit & 1);
+    }
+
+    // Bookings allowed on an open day; 0 means unlimited
+    uint32_t capacityFor(int32_t day, uint32_t regular) const {
+        if (!isReduced(day)) return regular;
+        if (reducedCapacity) return regular ? min(regular, reducedCapacity) : reducedCapacity;
+        return regular ? max(1u, regular / 2) : 0;
+    }
+
+    // "Independence Day", "Sunday" or "" for an open day
+    string closureReason(int32_t day) const {
+        auto name = dayNames.find(day);
+        if (name != dayNames.end() && isClosed(day)) return name->second;
+        if (weeklyClosures >> weekday(day) & 1) return kWeekdayNames[weekday(day)];
+        return isClosed(day) ? "holiday" : "";
+    }
+
+    // Visits open days from `from` on, in order, until visit returns false or
+    // the search horizon (two years) runs out
+    template<typename Visitor>
+    void forEachOpenDay(int32_t from, Visitor&& visit) const {
+        int32_t limit = from + kSearchHorizon;
+        Position at = locate(from);
+        uint64_t mask = ~0ULL << at.bit;
+        while (at.yearStart < limit) {
+            const YearBits* bits = bitsFor(at.year);
+            for (; int32_t(at.word * 64) < at.yearLength; ++at.word, mask = ~0ULL) {
+                uint64_t open = ~closedWord(at, bits) & mask;
+                while (open) {
+                    int32_t day = at.yearStart + int32_t(at.word * 64) + __builtin_ctzll(open);
+                    if (day >= limit || !visit(day)) return;
+                    open &= open - 1;
+                }
+            }
+            at = locate(at.yearStart + at.yearLength);
+        }
+    }
+
+    vector<int32_t> nextOpenDays(int32_t from, size_t count) const {
+        vector<int32_t> days;
+        if (!count) return days;
+        forEachOpenDay(from, [&](int32_t day) {
+            days.push_back(day);
+            return days.size() < count;
+        });
+        return days;
+    }
+};
+
+const char* const BusinessCalendar::kWeekdayNames[7] = {"Sunday", "Monday", "Tuesday", "Wednesday",
+                                                        "Thursday", "Friday", "Saturday"};
+
+// Reads a calendar file:
+//
+//   closed <weekday>...           regular weekly closures
+//   holiday <DD-MM-YYYY> [name]   closed all day
+//   reduced <DD-MM-YYYY> [name]   open with reduced capacity
+//   reduced-capacity <bookings>   capacity on reduced days (default: half)
+class BusinessCalendarLoader {
+private:
+    size_t lineNumber = 0;
+
+    [[noreturn]] void fail(const string& message) const {
+        throw invalid_argument("Calendar line " + to_string(lineNumber) + ": " + message);
+    }
+
+    int32_t day(istringstream& words) const {
+        string date;
+        words >> date;
+        int32_t parsed = parseDate(date);
+        if (parsed == kInvalidDay) fail("expected a DD-MM-YYYY date, got '" + date + "'");
+        return parsed;
+    }
+
+    static string rest(istringstream& words) {
+        string text;
+        getline(words >> ws, text);
+        while (!text.empty() && isspace(static_cast<unsigned char>(text.back()))) text.pop_back();
+        return text;
+    }
+
+public:
+    BusinessCalendar load(istream& in) {
+        BusinessCalendar calendar;
+        uint8_t closures = 0;
+        string line;
+
+        while (getline(in, line)) {
+            ++lineNumber;
+            line = line.substr(0, line.find('#'));
+            istringstream words(line);
+            string keyword;
+            if (!(words >> keyword)) continue;
+
+            if (keyword == "closed") {
+                string name;
+                while (words >> name) {
+                    // Full names or their first three letters, any case
+                    transform(name.begin(), name.end(), name.begin(), ::tolower);
+                    int weekday = 0;
+                    for (; weekday < 7; ++weekday) {
+                        string full = BusinessCalendar::kWeekdayNames[weekday];
+                        transform(full.begin(), full.end(), full.begin(), ::tolower);
+                        if (name == full || name == full.substr(0, 3)) break;
+                    }
+                    if (weekday == 7) fail("unknown weekday '" + name + "'");
+                    closures |= uint8_t(1u << weekday);
+                }
+            } else if (keyword == "holiday") {
+                int32_t holiday = day(words);
+                calendar.addHoliday(holiday, rest(words));
+            } else if (keyword == "reduced") {
+                int32_t reduced = day(words);
+                calendar.addReducedDay(reduced, rest(words));
+            } else if (keyword == "reduced-capacity") {
+                int capacity;
+                if (!(words >> capacity) || capacity <= 0) fail("expected 'reduced-capacity <bookings>'");
+                calendar.setReducedCapacity(uint32_t(capacity));
+            } else {
+                fail("unknown keyword '" + keyword + "'");
+            }
+        }
+        calendar.setWeeklyClosures(closures);
+        return calendar;
+    }
+};
+
+// Booking failures that a caller may want to wait out
+class SchedulingConflict : public runtime_error {
+public:
+    SchedulingConflict()
+        : runtime_error("Scheduling conflict: Vehicle already has an appointment on this date") {}
+};
+
+class CapacityExceeded : public runtime_error {
+public:
+    CapacityExceeded() : runtime_error("No capacity left on this date") {}
+};
+
+// Not worth waiting for: the center does not open that day
+class CenterClosed : public runtime_error {
+public:
+    CenterClosed(const string& date, const string& reason)
+        : runtime_error("Service center is closed on " + date + " (" + reason + ")") {}
+};
+
+// A bookable date found by slot search
+struct OpenSlot {
+    int32_t day;
+    uint32_t remaining;   // UINT32_MAX when the day has no capacity limit
+    bool reduced;
+};
+
+// Per-date waitlists ordered by priority (lower first), then arrival. A freed
+// slot pops the best entry in O(log n) without rescanning the queue.
+class Waitlist {
+public:
+    struct Entry {
+        uint8_t priority;
+        uint64_t sequence;
+        Client* client;
+        PlateString vehicleNumber;
+        const Service* service;
+        int32_t day;
+    };
+
+private:
+    struct Later {
+        bool operator()(const Entry& a, const Entry& b) const {
+            return a.priority != b.priority ? a.priority > b.priority : a.sequence > b.sequence;
+        }
+    };
+
+    unordered_map<int32_t, priority_queue<Entry, vector<Entry>, Later>> byDay;
+    uint64_t nextSequence = 0;
+    size_t total = 0;
+
+public:
+    // Returns how many requests are now waiting for that day
+    size_t add(Entry entry) {
+        entry.sequence = nextSequence++;
+        auto& queue = byDay[entry.day];
+        queue.push(entry);
+        ++total;
+        return queue.size();
+    }
+
+    bool popBest(int32_t day, Entry& out) {
+        auto it = byDay.find(day);
+        if (it == byDay.end()) return false;
+        out = it->second.top();
+        it->second.pop();
+        if (it->second.empty()) byDay.erase(it);
+        --total;
+        return true;
+    }
+
+    // Puts back an entry that could not be promoted, keeping its place in line
+    void restore(const Entry& entry) {
+        byDay[entry.day].push(entry);
+        ++total;
+    }
+
+    size_t waiting(int32_t day) const {
+        auto it = byDay.find(day);
+        return it == byDay.end() ? 0 : it->second.size();
+    }
+
+    size_t size() const { return total; }
+};
+
+// HH:MM to minutes after midnight; -1 when malformed
+inline int32_t parseClock(string_view text) {
+    if (text.size() != 5 || text[2] != ':') return -1;
+    for (size_t i : {0, 1, 3, 4}) {
+        if (!isdigit(static_cast<unsigned char>(text[i]))) return -1;
+    }
+    int32_t hours = (text[0] - '0') * 10 + (text[1] - '0');
+    int32_t minutes = (text[3] - '0') * 10 + (text[4] - '0');
+    if (hours > 23 || minutes > 59) return -1;
+    return hours * 60 + minutes;
+}
+
+inline string formatClock(int32_t minutes) {
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%02d:%02d", minutes / 60 % 100, minutes % 60);
+    return buffer;
+}
+
+// A technician's skills and shift, in minutes after midnight
+struct Technician {
+    string name;
+    uint32_t skills;
+    int32_t shiftStart;
+    int32_t shiftEnd;
+};
+
+// One unit of work to place: what it needs and how long it takes
+struct AssignmentJob {
+    uint32_t skills;
+    int32_t duration;
+};
+
+enum class AssignmentObjective { Makespan, Overtime };
+
+struct Assignment {
+    vector<int32_t> technicianFor;   // per job; -1 when no technician holds the skills
+    vector<int32_t> load;            // minutes of work per technician
+    int32_t makespan = 0;            // latest finish among busy technicians
+    int32_t overtime = 0;            // minutes worked past shift ends, summed
+    size_t unassigned = 0;
+    bool optimal = false;            // proven by the exact solver
+};
+
+// Assigns a day's jobs to technicians. Jobs run back to back from shift
+// start, so a technician's finish time is shiftStart + load. The heuristic is
+// longest-first greedy followed by move/swap local search on the technicians
+// that set the objective; days up to kExactJobLimit jobs are then solved
+// exactly by branch and bound seeded with the heuristic's answer.
+class TechnicianAssigner {
+public:
+    static constexpr size_t kExactJobLimit = 14;
+    static constexpr size_t kExactNodeLimit = 2000000;
+
+private:
+    const vector<Technician>& technicians;
+    const vector<AssignmentJob>& jobs;
+    AssignmentObjective objective;
+    vector<vector<int32_t>> eligible;   // technicians able to take each job
+
+    // Primary objective in the high bits, the other as a tie-break
+    int64_t score(const vector<int32_t>& load, int32_t* makespanOut = nullptr,
+                  int32_t* overtimeOut = nullptr) const {
+        int32_t makespan = 0, overtime = 0;
+        for (size_t t = 0; t < technicians.size(); ++t) {
+            if (!load[t]) continue;
+            int32_t finish = technicians[t].shiftStart + load[t];
+            makespan = max(makespan, finish);
+            overtime += max(0, finish - technicians[t].shiftEnd);
+        }
+        if (makespanOut) *makespanOut = makespan;
+        if (overtimeOut) *overtimeOut = overtime;
+        return objective == AssignmentObjective::Makespan
+                   ? (int64_t(makespan) << 32) + overtime
+                   : (int64_t(overtime) << 32) + makespan;
+    }
+
+    // Technicians whose work currently drives the objective
+    bool critical(const vector<int32_t>& load, size_t t, int32_t makespan) const {
+        int32_t finish = technicians[t].shiftStart + load[t];
+        return finish == makespan || finish > technicians[t].shiftEnd;
+    }
+
+    void finalize(Assignment& result) const {
+        score(result.load, &result.makespan, &result.overtime);
+        result.unassigned = count(result.technicianFor.begin(), result.technicianFor.end(), -1);
+    }
+
+    struct ExactSearch {
+        vector<size_t> order;
+        vector<int32_t> load;
+        vector<int32_t> choice;
+        vector<int32_t> best;
+        int64_t bestScore;
+        size_t nodes = 0;
+    };
+
+    void branch(ExactSearch& search, size_t depth) const {
+        if (++search.nodes > kExactNodeLimit) return;
+        int64_t current = score(search.load);
+        if (current >= search.bestScore) return;   // loads only grow deeper down
+        if (depth == search.order.size()) {
+            search.bestScore = current;
+            search.best = search.choice;
+            return;
+        }
+        size_t job = search.order[depth];
+        if (eligible[job].empty()) {
+            search.choice[job] = -1;
+            branch(search, depth + 1);
+            return;
+        }
+        for (size_t i = 0; i < eligible[job].size(); ++i) {
+            int32_t t = eligible[job][i];
+            // Identical technicians with equal load lead to mirrored subtrees
+            bool mirrored = false;
+            for (size_t k = 0; k < i && !mirrored; ++k) {
+                const Technician& a = technicians[eligible[job][k]];
+                const Technician& b = technicians[t];
+                mirrored = a.skills == b.skills && a.shiftStart == b.shiftStart &&
+                           a.shiftEnd == b.shiftEnd && search.load[eligible[job][k]] == search.load[t];
+            }
+            if (mirrored) continue;
+            search.load[t] += jobs[job].duration;
+            search.choice[job] = t;
+            branch(search, depth + 1);
+            search.load[t] -= jobs[job].duration;
+        }
+    }
+
+public:
+    TechnicianAssigner(const vector<Technician>& technicians, const vector<AssignmentJob>& jobs,
+                       AssignmentObjective objective)
+        : technicians(technicians), jobs(jobs), objective(objective), eligible(jobs.size()) {
+        for (size_t j = 0; j < jobs.size(); ++j) {
+            for (size_t t = 0; t < technicians.size(); ++t) {
+                if ((technicians[t].skills & jobs[j].skills) == jobs[j].skills) {
+                    eligible[j].push_back(static_cast<int32_t>(t));
+                }
+            }
+        }
+    }
+
+    // Longest job first, each to the technician that hurts the objective least
+    Assignment greedy() const {
+        Assignment result;
+        result.technicianFor.assign(jobs.size(), -1);
+        result.load.assign(technicians.size(), 0);
+        vector<size_t> order(jobs.size());
+        for (size_t j = 0; j < order.size(); ++j) order[j] = j;
+        sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            if (jobs[a].duration != jobs[b].duration) return jobs[a].duration > jobs[b].duration;
+            return eligible[a].size() < eligible[b].size();
+        });
+        for (size_t job : order) {
+            int64_t bestScore = INT64_MAX;
+            int32_t bestTech = -1;
+            for (int32_t t : eligible[job]) {
+                result.load[t] += jobs[job].duration;
+                int64_t s = score(result.load);
+                result.load[t] -= jobs[job].duration;
+                if (s < bestScore) {
+                    bestScore = s;
+                    bestTech = t;
+                }
+            }
+            result.technicianFor[job] = bestTech;
+            if (bestTech >= 0) result.load[bestTech] += jobs[job].duration;
+        }
+        finalize(result);
+        return result;
+    }
+
+    // First-improvement moves and swaps off critical technicians until a
+    // pass finds nothing or the pass limit is reached
+    void improve(Assignment& result, size_t maxPasses = 50) const {
+        vector<int32_t>& load = result.load;
+        vector<int32_t>& owner = result.technicianFor;
+        int32_t makespan = 0;
+        int64_t current = score(load, &makespan);
+        for (size_t pass = 0; pass < maxPasses; ++pass) {
+            bool improved = false;
+            for (size_t j = 0; j < jobs.size(); ++j) {
+                int32_t a = owner[j];
+                if (a < 0 || !critical(load, a, makespan)) continue;
+                int32_t d = jobs[j].duration;
+                bool moved = false;
+                for (int32_t b : eligible[j]) {
+                    if (b == a) continue;
+                    load[a] -= d;
+                    load[b] += d;
+                    int32_t trialMakespan;
+                    int64_t s = score(load, &trialMakespan);
+                    if (s < current) {
+                        owner[j] = b;
+                        current = s;
+                        makespan = trialMakespan;
+                        moved = improved = true;
+                        break;
+                    }
+                    load[a] += d;
+                    load[b] -= d;
+                }
+                if (moved) continue;
+                for (size_t k = 0; k < jobs.size() && !moved; ++k) {
+                    int32_t b = owner[k];
+                    if (b < 0 || b == a || jobs[k].duration >= d) continue;
+                    if ((technicians[a].skills & jobs[k].skills) != jobs[k].skills ||
+                        (technicians[b].skills & jobs[j].skills) != jobs[j].skills) {
+                        continue;
+                    }
+                    int32_t shift = d - jobs[k].duration;
+                    load[a] -= shift;
+                    load[b] += shift;
+                    int32_t trialMakespan;
+                    int64_t s = score(load, &trialMakespan);
+                    if (s < current) {
+                        swap(owner[j], owner[k]);
+                        current = s;
+                        makespan = trialMakespan;
+                        moved = improved = true;
+                    } else {
+                        load[a] += shift;
+                        load[b] -= shift;
+                    }
+                }
+            }
+            if (!improved) break;
+        }
+        finalize(result);
+    }
+
+    // Branch and bound for small days; keeps `seed` if the node budget runs
+    // out before the search space is exhausted
+    Assignment exact(const Assignment& seed) const {
+        if (jobs.size() > kExactJobLimit) {
+            throw invalid_argument("Exact assignment is limited to " + to_string(kExactJobLimit) + " jobs");
+        }
+        ExactSearch search;
+        search.order.resize(jobs.size());
+        for (size_t j = 0; j < jobs.size(); ++j) search.order[j] = j;
+        sort(search.order.begin(), search.order.end(),
+             [&](size_t a, size_t b) { return jobs[a].duration > jobs[b].duration; });
+        search.load.assign(technicians.size(), 0);
+        search.choice.assign(jobs.size(), -1);
+        search.best = seed.technicianFor;
+        search.bestScore = score(seed.load) + 1;   // lets an equal-cost proof through
+        branch(search, 0);
+
+        Assignment result;
+        result.technicianFor = search.best;
+        result.load.assign(technicians.size(), 0);
+        for (size_t j = 0; j < jobs.size(); ++j) {
+            if (result.technicianFor[j] >= 0) result.load[result.technicianFor[j]] += jobs[j].duration;
+        }
+        result.optimal = search.nodes <= kExactNodeLimit;
+        finalize(result);
+        return result;
+    }
+
+    Assignment solve(bool allowExact = true) const {
+        Assignment result = greedy();
+        improve(result);
+        if (allowExact && jobs.size() <= kExactJobLimit) result = exact(result);
+        return result;
+    }
+};
+
+// A day's open appointments and the technician chosen for each
+struct TechnicianPlan {
+    vector<const ServiceAppointment*> appointments;
+    Assignment assignment;
+};
+
+// Service Appointment class
+class ServiceAppointment {
+private:
+    Client* client;               // owned by the ServiceCenter
+    PlateString vehicleNumber;
+    const Service* service;       // owned by the ServiceCenter
+    DateString scheduledDate;
+    const Workflow* workflow;     // kept alive by the ServiceCenter
+    uint8_t state;
+    ServiceCenter* serviceCenter;
+    ServiceRecord* historyEntry = nullptr;
+    unique_ptr<SubscriberList> subscribers;   // created on first subscription
+
+public:
+    enum class TransitionResult { Applied, NotAllowed, GuardRejected };
+
+    ServiceAppointment(Client& client, string_view vehicleNum,
+                      const Service& service, string_view date,
+                      const Workflow& workflow, ServiceCenter* center)
+        : client(&client), vehicleNumber(vehicleNum), service(&service),
+          scheduledDate(date), workflow(&workflow), state(workflow.initial()),
+          serviceCenter(center) {}
+
+    // What fire(event) would do from the current state, without doing it
+    TransitionResult check(uint8_t event) const {
+        if (event >= workflow->eventCount()) return TransitionResult::NotAllowed;
+        const Workflow::Transition& t = workflow->transition(state, event);
+        if (t.target == Workflow::kNone) return TransitionResult::NotAllowed;
+        if (t.guard != Workflow::kNone && !workflow->guard(t.guard)(*this)) {
+            return TransitionResult::GuardRejected;
+        }
+        return TransitionResult::Applied;
+    }
+
+    TransitionResult fire(uint8_t event) {
+        TransitionResult result = check(event);
+        if (result != TransitionResult::Applied) return result;
+        const Workflow::Transition& t = workflow->transition(state, event);
+        uint8_t from = state;
+        state = t.target;
+        if (t.hook != Workflow::kNone) workflow->hook(t.hook)(*this, workflow->label(from), workflow->label(state));
+        return TransitionResult::Applied;
+    }
+
+    TransitionResult progressState() { return fire(workflow->nextEvent()); }
+
+    uint8_t getState() const { return state; }
+    string_view getStatus() const { return workflow->label(state); }
+    StateKind getStateKind() const { return workflow->phase(state); }
+    const Workflow& getWorkflow() const { return *workflow; }
+
+    void attachHistory(ServiceRecord* entry) { historyEntry = entry; }
+
+    // Watchers besides the booking client; the center creates the list
+    // under its book lock, notifiers only read the pointer
+    SubscriberList& watchers() {
+        if (!subscribers) subscribers = make_unique<SubscriberList>();
+        return *subscribers;
+    }
+    SubscriberList* getWatchers() const { return subscribers.get(); }
+    void adoptWatchers(ServiceAppointment& from) { subscribers = move(from.subscribers); }
+    ServiceRecord* getHistory() const { return historyEntry; }
+
+    // Borrowed references: valid for the lifetime of the owning center
+    Client& getClient() const { return *client; }
+    string_view getVehicleNumber() const { return vehicleNumber.view(); }
+    const Service& getService() const { return *service; }
+    string_view getScheduledDate() const { return scheduledDate.view(); }
+};
+
+// pmr resource that tallies the bytes it forwards to its upstream resource
+class CountingResource : public pmr::memory_resource {
+private:
+    pmr::memory_resource* upstream;
+    atomic<size_t> liveBytes{0};
+    atomic<size_t> peakBytes{0};
+    atomic<size_t> allocationCount{0};
+    atomic<size_t> liveCount{0};
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        void* p = upstream->allocate(bytes, alignment);
+        size_t live = liveBytes.fetch_add(bytes, memory_order_relaxed) + bytes;
+        size_t peak = peakBytes.load(memory_order_relaxed);
+        while (live > peak && !peakBytes.compare_exchange_weak(peak, live, memory_order_relaxed)) {}
+        allocationCount.fetch_add(1, memory_order_relaxed);
+        liveCount.fetch_add(1, memory_order_relaxed);
+        return p;
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        upstream->deallocate(p, bytes, alignment);
+        liveBytes.fetch_sub(bytes, memory_order_relaxed);
+        liveCount.fetch_sub(1, memory_order_relaxed);
+    }
+
+    bool do_is_equal(const pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    explicit CountingResource(pmr::memory_resource* upstream = pmr::get_default_resource())
+        : upstream(upstream) {}
+
+    size_t live() const { return liveBytes.load(memory_order_relaxed); }
+    size_t peak() const { return peakBytes.load(memory_order_relaxed); }
+    size_t allocations() const { return allocationCount.load(memory_order_relaxed); }
+    size_t liveAllocations() const { return liveCount.load(memory_order_relaxed); }
+};
+
+// One row of a center's memory report
+struct MemoryUsage {
+    const char* category;
+    size_t objects;
+    size_t liveBytes;
+    size_t peakBytes;
+};
+
+#ifdef __linux__
+// Fixed pool of page-aligned write buffers. io_uring registers them once so
+// fixed writes skip per-request page pinning. acquire() blocks only when
+// every buffer is in flight, which is the layer's backpressure.
+class IoBufferPool {
+private:
+    size_t bufferSize;
+    vector<char*> buffers;
+    vector<uint32_t> freeList;
+    mutex poolMutex;
+    condition_variable available;
+
+public:
+    IoBufferPool(size_t count, size_t bufferSize) : bufferSize(bufferSize) {
+        for (size_t i = 0; i < count; ++i) {
+            char* memory = static_cast<char*>(aligned_alloc(4096, bufferSize));
+            if (!memory) throw bad_alloc();
+            buffers.push_back(memory);
+            freeList.push_back(static_cast<uint32_t>(count - 1 - i));
+        }
+    }
+
+    ~IoBufferPool() {
+        for (char* memory : buffers) free(memory);
+    }
+
+    IoBufferPool(const IoBufferPool&) = delete;
+    IoBufferPool& operator=(const IoBufferPool&) = delete;
+
+    uint32_t acquire() {
+        unique_lock<mutex> lock(poolMutex);
+        available.wait(lock, [&] { return !freeList.empty(); });
+        uint32_t index = freeList.back();
+        freeList.pop_back();
+        return index;
+    }
+
+    void release(uint32_t index) {
+        {
+            lock_guard<mutex> lock(poolMutex);
+            freeList.push_back(index);
+        }
+        available.notify_one();
+    }
+
+    char* data(uint32_t index) const { return buffers[index]; }
+    size_t capacity() const { return bufferSize; }
+    size_t count() const { return buffers.size(); }
+};
+
+// One positional write of a pooled buffer
+struct IoRequest {
+    int fd;
+    uint32_t buffer;
+    uint32_t length;
+    uint64_t offset;
+};
+
+// Completes writes asynchronously and hands buffers back to the pool.
+// submit() may hold requests back until flush() to batch them.
+class AsyncIoBackend {
+protected:
+    IoBufferPool& pool;
+    mutex stateMutex;
+    condition_variable idle;
+    size_t outstanding = 0;
+    string firstError;
+    atomic<uint64_t> syscalls{0};
+
+    void started() {
+        lock_guard<mutex> lock(stateMutex);
+        ++outstanding;
+    }
+
+    void completed(uint32_t buffer, const char* error) {
+        pool.release(buffer);
+        lock_guard<mutex> lock(stateMutex);
+        if (error && firstError.empty()) firstError = error;
+        if (--outstanding == 0) idle.notify_all();
+    }
+
+public:
+    explicit AsyncIoBackend(IoBufferPool& pool) : pool(pool) {}
+    virtual ~AsyncIoBackend() = default;
+
+    virtual const char* name() const = 0;
+    virtual void submit(const IoRequest& request) = 0;
+    virtual void flush() = 0;
+
+    // Flushes, then blocks until every submitted write has completed;
+    // throws the first write error seen since the last drain
+    void drain() {
+        flush();
+        unique_lock<mutex> lock(stateMutex);
+        idle.wait(lock, [&] { return outstanding == 0; });
+        if (!firstError.empty()) {
+            string error = move(firstError);
+            firstError.clear();
+            throw runtime_error("Async write failed: " + error);
+        }
+    }
+
+    uint64_t syscallCount() const { return syscalls.load(memory_order_relaxed); }
+};
+
+// io_uring through raw syscalls: SQ/CQ rings mapped once, buffers
+// registered for IORING_OP_WRITE_FIXED, and submissions batched so one
+// io_uring_enter covers up to batchSize writes. A reaper thread blocks on
+// the completion queue.
+class IoUringBackend : public AsyncIoBackend {
+private:
+    static constexpr uint64_t kWakeReaper = UINT64_MAX;
+
+    int ringFd = -1;
+    io_uring_params params{};
+    void* sqRing = MAP_FAILED;
+    void* cqRing = MAP_FAILED;
+    size_t sqRingBytes = 0;
+    size_t cqRingBytes = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned* sqMask;
+    unsigned* sqArray;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned* cqMask;
+    io_uring_cqe* cqes;
+    bool fixedBuffers = false;
+    size_t batchSize;
+    unsigned unsubmitted = 0;
+    mutex submitMutex;
+    thread reaper;
+    // Buffers handed to the ring and not yet completed, so that a reaper
+    // that can no longer wait on the ring can fail them instead of leaving
+    // drain() blocked; ringError is set once it has given up
+    unique_ptr<atomic<bool>[]> inFlight;
+    string ringError;   // guarded by submitMutex
+
+    int enter(unsigned toSubmit, unsigned minComplete, unsigned flags) {
+        for (;;) {
+            syscalls.fetch_add(1, memory_order_relaxed);
+            int result = static_cast<int>(syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, nullptr, 0));
+            if (result >= 0 || errno != EINTR) return result;
+        }
+    }
+
+    // Caller holds submitMutex
+    void submitPending() {
+        while (unsubmitted) {
+            int done = enter(unsubmitted, 0, 0);
+            if (done < 0) throw runtime_error(string("io_uring_enter: ") + strerror(errno));
+            unsubmitted -= static_cast<unsigned>(done);
+        }
+    }
+
+    // Caller holds submitMutex
+    io_uring_sqe& nextSqe() {
+        unsigned tail = *sqTail;
+        if (tail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) == params.sq_entries) submitPending();
+        io_uring_sqe& sqe = sqes[tail & *sqMask];
+        memset(&sqe, 0, sizeof(sqe));
+        sqArray[tail & *sqMask] = tail & *sqMask;
+        return sqe;
+    }
+
+    // Caller holds submitMutex
+    void push() {
+        __atomic_store_n(sqTail, *sqTail + 1, __ATOMIC_RELEASE);
+        ++unsubmitted;
+    }
+
+    // Fails every write still owned by the ring; later submits fail at once
+    void abandonRing(const string& error) {
+        {
+            lock_guard<mutex> lock(submitMutex);
+            ringError = "io_uring_enter: " + error;
+        }
+        for (size_t i = 0; i < pool.count(); ++i) {
+            if (inFlight[i].exchange(false, memory_order_acq_rel)) {
+                completed(static_cast<uint32_t>(i), ("io_uring_enter: " + error).c_str());
+            }
+        }
+    }
+
+    void reap() {
+        for (;;) {
+            // EAGAIN and EBUSY clear once the completions below are consumed
+            int waited = enter(0, 1, IORING_ENTER_GETEVENTS);
+            int waitError = waited < 0 ? errno : 0;
+            unsigned head = *cqHead;
+            unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+            bool stop = false;
+            for (; head != tail; ++head) {
+                const io_uring_cqe& cqe = cqes[head & *cqMask];
+                if (cqe.user_data == kWakeReaper) {
+                    stop = true;
+                    continue;
+                }
+                uint32_t buffer = static_cast<uint32_t>(cqe.user_data >> 32);
+                uint32_t length = static_cast<uint32_t>(cqe.user_data);
+                const char* error = cqe.res < 0 ? strerror(-cqe.res)
+                                    : static_cast<uint32_t>(cqe.res) != length ? "short write" : nullptr;
+                inFlight[buffer].store(false, memory_order_release);
+                completed(buffer, error);
+            }
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+            if (stop) return;
+            if (waitError && waitError != EAGAIN && waitError != EBUSY) {
+                abandonRing(strerror(waitError));
+                return;
+            }
+        }
+    }
+
+    void unmap() {
+        if (sqes != MAP_FAILED) munmap(sqes, params.sq_entries * sizeof(io_uring_sqe));
+        if (cqRing != MAP_FAILED && cqRing != sqRing) munmap(cqRing, cqRingBytes);
+        if (sqRing != MAP_FAILED) munmap(sqRing, sqRingBytes);
+        if (ringFd >= 0) ::close(ringFd);
+    }
+
+public:
+    IoUringBackend(IoBufferPool& pool, size_t batchSize = 8)
+        : AsyncIoBackend(pool), batchSize(max<size_t>(batchSize, 1)) {
+        // Every pooled buffer can be in flight at once without overflowing the CQ
+        unsigned entries = 1;
+        while (entries < pool.count()) entries <<= 1;
+        ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ringFd < 0) throw runtime_error(string("io_uring_setup: ") + strerror(errno));
+
+        sqRingBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP) sqRingBytes = cqRingBytes = max(sqRingBytes, cqRingBytes);
+        sqRing = mmap(nullptr, sqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        cqRing = (params.features & IORING_FEAT_SINGLE_MMAP)
+                     ? sqRing
+                     : mmap(nullptr, cqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd,
+                            IORING_OFF_CQ_RING);
+        sqes = static_cast<io_uring_sqe*>(mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe),
+                                               PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd,
+                                               IORING_OFF_SQES));
+        if (sqRing == MAP_FAILED || cqRing == MAP_FAILED || sqes == MAP_FAILED) {
+            unmap();
+            throw runtime_error("io_uring ring mmap failed");
+        }
+        char* sq = static_cast<char*>(sqRing);
+        char* cq = static_cast<char*>(cqRing);
+        sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        vector<iovec> vectors(pool.count());
+        for (size_t i = 0; i < pool.count(); ++i) vectors[i] = {pool.data(static_cast<uint32_t>(i)), pool.capacity()};
+        fixedBuffers = syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_BUFFERS, vectors.data(),
+                               static_cast<unsigned>(vectors.size())) == 0;
+        inFlight = make_unique<atomic<bool>[]>(pool.count());
+        reaper = thread([this] { reap(); });
+    }
+
+    ~IoUringBackend() override {
+        try {
+            drain();
+        } catch (const exception&) {
+        }
+        {
+            lock_guard<mutex> lock(submitMutex);
+            // A reaper that gave up on the ring has already exited
+            if (ringError.empty()) {
+                io_uring_sqe& sqe = nextSqe();
+                sqe.opcode = IORING_OP_NOP;
+                sqe.user_data = kWakeReaper;
+                push();
+                try {
+                    submitPending();
+                } catch (const exception&) {
+                }
+            }
+        }
+        reaper.join();
+        unmap();
+    }
+
+    const char* name() const override { return fixedBuffers ? "io_uring (fixed buffers)" : "io_uring"; }
+
+    void submit(const IoRequest& request) override {
+        started();
+        unique_lock<mutex> lock(submitMutex);
+        if (!ringError.empty()) {
+            string error = ringError;
+            lock.unlock();
+            completed(request.buffer, error.c_str());
+            return;
+        }
+        io_uring_sqe& sqe = nextSqe();
+        sqe.opcode = fixedBuffers ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+        sqe.fd = request.fd;
+        sqe.addr = reinterpret_cast<uint64_t>(pool.data(request.buffer));
+        sqe.len = request.length;
+        sqe.off = request.offset;
+        sqe.buf_index = fixedBuffers ? static_cast<uint16_t>(request.buffer) : 0;
+        sqe.user_data = (uint64_t(request.buffer) << 32) | request.length;
+        inFlight[request.buffer].store(true, memory_order_relaxed);
+        push();
+        if (unsubmitted >= batchSize) submitPending();
+    }
+
+    void flush() override {
+        lock_guard<mutex> lock(submitMutex);
+        submitPending();
+    }
+};
+
+// Fallback for kernels or sandboxes without io_uring: worker threads pwrite
+class ThreadPoolIoBackend : public AsyncIoBackend {
+private:
+    queue<IoRequest> requests;
+    mutex queueMutex;
+    condition_variable ready;
+    bool stopping = false;
+    vector<thread> workers;
+
+    void work() {
+        for (;;) {
+            IoRequest request;
+            {
+                unique_lock<mutex> lock(queueMutex);
+                ready.wait(lock, [&] { return stopping || !requests.empty(); });
+                if (requests.empty()) return;
+                request = requests.front();
+                requests.pop();
+            }
+            const char* data = pool.data(request.buffer);
+            size_t written = 0;
+            const char* error = nullptr;
+            while (written < request.length) {
+                syscalls.fetch_add(1, memory_order_relaxed);
+                ssize_t n = pwrite(request.fd, data + written, request.length - written, request.offset + written);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) {
+                    error = n < 0 ? strerror(errno) : "short write";
+                    break;
+                }
+                written += static_cast<size_t>(n);
+            }
+            completed(request.buffer, error);
+        }
+    }
+
+public:
+    explicit ThreadPoolIoBackend(IoBufferPool& pool, size_t threads = 2) : AsyncIoBackend(pool) {
+        for (size_t i = 0; i < max<size_t>(threads, 1); ++i) workers.emplace_back([this] { work(); });
+    }
+
+    ~ThreadPoolIoBackend() override {
+        {
+            lock_guard<mutex> lock(queueMutex);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    const char* name() const override { return "thread-pool pwrite"; }
+
+    void submit(const IoRequest& request) override {
+        started();
+        {
+            lock_guard<mutex> lock(queueMutex);
+            requests.push(request);
+        }
+        ready.notify_one();
+    }
+
+    void flush() override {}
+};
+
+enum class AsyncIoMode { Auto, IoUring, ThreadPool };
+
+// Buffer pool plus the backend writing it. Auto prefers io_uring and falls
+// back to the thread pool when the ring cannot be set up.
+class AsyncIo {
+private:
+    IoBufferPool pool;
+    unique_ptr<AsyncIoBackend> backend;
+
+public:
+    explicit AsyncIo(AsyncIoMode mode = AsyncIoMode::Auto, size_t buffers = 32, size_t bufferSize = 256 * 1024)
+        : pool(buffers, bufferSize) {
+        if (mode != AsyncIoMode::ThreadPool) {
+            try {
+                backend = make_unique<IoUringBackend>(pool);
+            } catch (const runtime_error&) {
+                if (mode == AsyncIoMode::IoUring) throw;
+            }
+        }
+        if (!backend) backend = make_unique<ThreadPoolIoBackend>(pool);
+    }
+
+    IoBufferPool& buffers() { return pool; }
+    AsyncIoBackend& io() { return *backend; }
+};
+
+// Append-only file written through AsyncIo. append() copies into the current
+// pooled buffer and hands full buffers to the backend, so callers never wait
+// on the disk, only on buffer exhaustion.
+class AsyncFile {
+private:
+    static constexpr uint32_t kNoBuffer = UINT32_MAX;
+
+    AsyncIo& io;
+    int fd;
+    string path;
+    uint64_t offset = 0;
+    uint32_t current = kNoBuffer;
+    size_t used = 0;
+    mutex appendMutex;
+
+    // Caller holds appendMutex
+    void submitCurrent() {
+        if (current == kNoBuffer) return;
+        io.io().submit({fd, current, static_cast<uint32_t>(used), offset});
+        offset += used;
+        current = kNoBuffer;
+        used = 0;
+    }
+
+public:
+    AsyncFile(AsyncIo& io, const string& path) : io(io), path(path) {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) throw runtime_error("Cannot open " + path + ": " + strerror(errno));
+    }
+
+    ~AsyncFile() {
+        try {
+            close();
+        } catch (const exception& e) {
+            cerr << "Error: " << e.what() << endl;
+        }
+    }
+
+    AsyncFile(const AsyncFile&) = delete;
+    AsyncFile& operator=(const AsyncFile&) = delete;
+
+    void append(string_view text) {
+        lock_guard<mutex> lock(appendMutex);
+        while (!text.empty()) {
+            if (current == kNoBuffer) current = io.buffers().acquire();
+            size_t n = min(text.size(), io.buffers().capacity() - used);
+            memcpy(io.buffers().data(current) + used, text.data(), n);
+            used += n;
+            text.remove_prefix(n);
+            if (used == io.buffers().capacity()) submitCurrent();
+        }
+    }
+
+    // Submits the partial buffer; completion is still asynchronous
+    void flush() {
+        {
+            lock_guard<mutex> lock(appendMutex);
+            submitCurrent();
+        }
+        io.io().flush();
+    }
+
+    // Submits the partial buffer, waits for every write on the backend and
+    // makes the file durable; throws the first write error since the last wait
+    void sync() {
+        flush();
+        io.io().drain();
+        if (fdatasync(fd) != 0) throw runtime_error("Cannot sync " + path + ": " + strerror(errno));
+    }
+
+    // Waits for every write of this file (and any other file on the same
+    // backend) and closes it
+    void close() {
+        if (fd < 0) return;
+        flush();
+        io.io().drain();
+        ::close(fd);
+        fd = -1;
+    }
+
+    uint64_t bytesWritten() {
+        lock_guard<mutex> lock(appendMutex);
+        return offset + used;
+    }
+
+    const string& getPath() const { return path; }
+};
+#endif
+
+#ifdef __linux__
+// Shared-memory mirror of the appointment book for co-located read-only
+// processes. The layout is position independent: records and strings are
+// addressed by offsets from the segment base, never by pointers. Each record
+// carries its own seqlock (odd while the writer updates it); the header
+// publishes the record count with release semantics and bumps an epoch on
+// every change so readers can poll cheaply for news.
+//
+//   [SharedStoreHeader][records: capacity x SharedAppointmentRecord][strings]
+//
+// Strings are stored once as [uint16 length][bytes] and never modified, so
+// readers hand out string_views straight into the mapping.
+struct SharedStoreHeader {
+    static constexpr uint64_t kMagic = 0x53435348424f4f4bULL;   // "SCSHBOOK"
+    static constexpr uint32_t kLayoutVersion = 1;
+
+    uint64_t magic;
+    uint32_t layoutVersion;
+    uint32_t recordSize;
+    uint64_t capacity;
+    uint64_t recordsOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsCapacity;
+    atomic<uint64_t> count;
+    atomic<uint64_t> stringsUsed;
+    atomic<uint64_t> epoch;
+    atomic<uint64_t> dropped;       // bookings not mirrored because the segment is full
+    atomic<uint32_t> writerAlive;
+};
+
+struct SharedAppointmentRecord {
+    atomic<uint32_t> sequence;
+    // Mutable, read under the seqlock
+    uint32_t statusOffset;
+    uint8_t stateKind;
+    // Written once before the record is published
+    uint8_t serviceKind;
+    uint8_t vehicleLength;
+    uint8_t dateLength;
+    int32_t day;
+    float cost;
+    uint32_t serviceOffset;
+    uint32_t clientOffset;
+    uint32_t contactOffset;
+    char vehicle[kMaxPlateLength + 1];
+    char date[12];
+};
+
+static_assert(atomic<uint64_t>::is_always_lock_free && atomic<uint32_t>::is_always_lock_free,
+              "shared-memory atomics must be address-free");
+
+// One appointment as seen by a reader; views point into the mapping
+struct SharedAppointment {
+    string_view vehicle;
+    string_view date;
+    string_view status;
+    string_view service;
+    string_view client;
+    string_view contact;
+    StateKind state;
+    ServiceKind serviceKind;
+    float cost;
+    int32_t day;
+};
+
+// Writer side: creates the segment and mirrors bookings and transitions.
+// Calls must be serialized (the center makes them under its book lock).
+class SharedAppointmentStore {
+private:
+    string name;
+    size_t bytes;
+    char* base;
+    SharedStoreHeader* header;
+    unordered_map<string, uint32_t> stringOffsets;
+
+    SharedAppointmentRecord* records() {
+        return reinterpret_cast<SharedAppointmentRecord*>(base + header->recordsOffset);
+    }
+
+    // Offset of a stored copy of text; 0 (the empty string) if the area is full
+    uint32_t storeString(string_view text) {
+        if (text.empty()) return 0;
+        auto it = stringOffsets.find(string(text));
+        if (it != stringOffsets.end()) return it->second;
+        size_t length = min<size_t>(text.size(), UINT16_MAX);
+        uint64_t used = header->stringsUsed.load(memory_order_relaxed);
+        if (used + 2 + length > header->stringsCapacity) return 0;
+        char* at = base + header->stringsOffset + used;
+        uint16_t prefix = static_cast<uint16_t>(length);
+        memcpy(at, &prefix, 2);
+        memcpy(at + 2, text.data(), length);
+        header->stringsUsed.store(used + 2 + length, memory_order_release);
+        uint32_t offset = static_cast<uint32_t>(used);
+        stringOffsets.emplace(string(text), offset);
+        return offset;
+    }
+
+public:
+    SharedAppointmentStore(const string& name, size_t capacity = 1 << 20, size_t stringBytes = 32 << 20)
+        : name(name) {
+        size_t recordsOffset = (sizeof(SharedStoreHeader) + 63) / 64 * 64;
+        size_t stringsOffset = recordsOffset + capacity * sizeof(SharedAppointmentRecord);
+        bytes = stringsOffset + stringBytes;
+        if (stringBytes > UINT32_MAX) throw invalid_argument("String area too large");
+
+        int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) throw runtime_error("shm_open " + name + ": " + strerror(errno));
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            ::close(fd);
+            shm_unlink(name.c_str());
+            throw runtime_error("Cannot size shared segment " + name);
+        }
+        void* mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            shm_unlink(name.c_str());
+            throw runtime_error("Cannot map shared segment " + name);
+        }
+        base = static_cast<char*>(mapping);
+        header = new (base) SharedStoreHeader{SharedStoreHeader::kMagic, SharedStoreHeader::kLayoutVersion,
+                                              sizeof(SharedAppointmentRecord), capacity, recordsOffset,
+                                              stringsOffset, stringBytes, {0}, {2}, {0}, {0}, {1}};
+        // Offset 0 is the empty string: a zero length prefix
+        memset(base + stringsOffset, 0, 2);
+    }
+
+    ~SharedAppointmentStore() {
+        header->writerAlive.store(0, memory_order_release);
+        munmap(base, bytes);
+        shm_unlink(name.c_str());
+    }
+
+    SharedAppointmentStore(const SharedAppointmentStore&) = delete;
+    SharedAppointmentStore& operator=(const SharedAppointmentStore&) = delete;
+
+    // Publishes appointment `id`, which must be the next one in the book.
+    // Once the segment is full count stops at capacity, so every later
+    // booking is counted as dropped before the ordering check.
+    void append(uint32_t id, const ServiceAppointment& apt) {
+        if (id >= header->capacity) {
+            header->dropped.fetch_add(1, memory_order_relaxed);
+            return;
+        }
+        if (id != header->count.load(memory_order_relaxed)) return;
+        SharedAppointmentRecord& record = records()[id];
+        string_view vehicle = apt.getVehicleNumber(), date = apt.getScheduledDate();
+        record.sequence.store(0, memory_order_relaxed);
+        record.statusOffset = storeString(apt.getStatus());
+        record.stateKind = static_cast<uint8_t>(apt.getStateKind());
+        record.serviceKind = static_cast<uint8_t>(apt.getService().getKind());
+        record.vehicleLength = static_cast<uint8_t>(min(vehicle.size(), sizeof(record.vehicle)));
+        record.dateLength = static_cast<uint8_t>(min(date.size(), sizeof(record.date)));
+        memcpy(record.vehicle, vehicle.data(), record.vehicleLength);
+        memcpy(record.date, date.data(), record.dateLength);
+        record.day = apt.getHistory()->day;
+        record.cost = apt.getHistory()->cost;
+        record.serviceOffset = storeString(apt.getService().getDescription());
+        record.clientOffset = storeString(apt.getClient().getName());
+        record.contactOffset = storeString(apt.getClient().getContact());
+        header->count.store(id + 1, memory_order_release);
+        header->epoch.fetch_add(1, memory_order_release);
+    }
+
+    // Republishes the mutable fields after a state change
+    void update(uint32_t id, const ServiceAppointment& apt) {
+        if (id >= header->count.load(memory_order_relaxed)) return;
+        SharedAppointmentRecord& record = records()[id];
+        uint32_t offset = storeString(apt.getStatus());
+        uint32_t sequence = record.sequence.load(memory_order_relaxed);
+        record.sequence.store(sequence + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        record.statusOffset = offset;
+        record.stateKind = static_cast<uint8_t>(apt.getStateKind());
+        record.sequence.store(sequence + 2, memory_order_release);
+        header->epoch.fetch_add(1, memory_order_release);
+    }
+
+    const string& getName() const { return name; }
+};
+
+// Reader side: maps a store read-only. Queries copy nothing but the few
+// mutable fields needed to validate a seqlock read.
+class SharedAppointmentView {
+private:
+    size_t bytes;
+    const char* base;
+    const SharedStoreHeader* header;
+
+    string_view stringAt(uint32_t offset) const {
+        if (offset + 2 > header->stringsCapacity) return {};
+        const char* at = base + header->stringsOffset + offset;
+        uint16_t length;
+        memcpy(&length, at, 2);
+        if (offset + 2 + length > header->stringsCapacity) return {};
+        return string_view(at + 2, length);
+    }
+
+public:
+    explicit SharedAppointmentView(const string& name) {
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) throw runtime_error("shm_open " + name + ": " + strerror(errno));
+        struct stat info;
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SharedStoreHeader)) {
+            ::close(fd);
+            throw runtime_error("Shared segment " + name + " is not an appointment store");
+        }
+        bytes = static_cast<size_t>(info.st_size);
+        void* mapping = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) throw runtime_error("Cannot map shared segment " + name);
+        base = static_cast<const char*>(mapping);
+        header = reinterpret_cast<const SharedStoreHeader*>(base);
+        if (header->magic != SharedStoreHeader::kMagic || header->layoutVersion != SharedStoreHeader::kLayoutVersion ||
+            header->recordSize != sizeof(SharedAppointmentRecord) ||
+            header->stringsOffset + header->stringsCapacity > bytes) {
+            munmap(const_cast<char*>(base), bytes);
+            throw runtime_error("Shared segment " + name + " has an incompatible layout");
+        }
+    }
+
+    ~SharedAppointmentView() { munmap(const_cast<char*>(base), bytes); }
+
+    SharedAppointmentView(const SharedAppointmentView&) = delete;
+    SharedAppointmentView& operator=(const SharedAppointmentView&) = delete;
+
+    size_t size() const { return header->count.load(memory_order_acquire); }
+    uint64_t epoch() const { return header->epoch.load(memory_order_acquire); }
+    uint64_t dropped() const { return header->dropped.load(memory_order_relaxed); }
+    bool writerAlive() const { return header->writerAlive.load(memory_order_acquire) != 0; }
+
+    // Reads record `index` (< size()); retries while the writer is mid-update
+    SharedAppointment read(size_t index) const {
+        const auto& record = reinterpret_cast<const SharedAppointmentRecord*>(base + header->recordsOffset)[index];
+        SharedAppointment out;
+        uint32_t statusOffset;
+        uint8_t stateKind;
+        for (;;) {
+            uint32_t before = record.sequence.load(memory_order_acquire);
+            if (before & 1) continue;
+            statusOffset = record.statusOffset;
+            stateKind = record.stateKind;
+            atomic_thread_fence(memory_order_acquire);
+            if (record.sequence.load(memory_order_relaxed) == before) break;
+        }
+        out.vehicle = string_view(record.vehicle, record.vehicleLength);
+        out.date = string_view(record.date, record.dateLength);
+        out.status = stringAt(statusOffset);
+        out.service = stringAt(record.serviceOffset);
+        out.client = stringAt(record.clientOffset);
+        out.contact = stringAt(record.contactOffset);
+        out.state = static_cast<StateKind>(min<uint8_t>(stateKind, kStateKindCount - 1));
+        out.serviceKind = static_cast<ServiceKind>(min<uint8_t>(record.serviceKind, kServiceKindCount - 1));
+        out.cost = record.cost;
+        out.day = record.day;
+        return out;
+    }
+
+    template<typename Visitor>
+    void forEach(Visitor&& visit) const {
+        size_t count = size();
+        for (size_t i = 0; i < count; ++i) visit(read(i));
+    }
+};
+#endif
+
+// Fixed set of threads draining a FIFO of tasks
+class WorkerPool {
+private:
+    queue<function<void()>> tasks;
+    mutex queueMutex;
+    condition_variable ready;
+    bool stopping = false;
+    vector<thread> threads;
+
+public:
+    explicit WorkerPool(size_t count) {
+        for (size_t i = 0; i < max<size_t>(count, 1); ++i) {
+            threads.emplace_back([this] {
+                for (;;) {
+                    function<void()> task;
+                    {
+                        unique_lock<mutex> lock(queueMutex);
+                        ready.wait(lock, [&] { return stopping || !tasks.empty(); });
+                        if (tasks.empty()) return;
+                        task = move(tasks.front());
+                        tasks.pop();
+                    }
+                    task();
+                }
+            });
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            lock_guard<mutex> lock(queueMutex);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (auto& worker : threads) worker.join();
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void submit(function<void()> task) {
+        {
+            lock_guard<mutex> lock(queueMutex);
+            tasks.push(move(task));
+        }
+        ready.notify_one();
+    }
+
+    size_t size() const { return threads.size(); }
+};
+
+// Render buffers that keep their capacity between reports
+class RenderBufferPool {
+private:
+    vector<unique_ptr<string>> spare;
+    mutex poolMutex;
+
+public:
+    unique_ptr<string> acquire() {
+        lock_guard<mutex> lock(poolMutex);
+        if (spare.empty()) return make_unique<string>();
+        unique_ptr<string> buffer = move(spare.back());
+        spare.pop_back();
+        buffer->clear();
+        return buffer;
+    }
+
+    void release(unique_ptr<string> buffer) {
+        lock_guard<mutex> lock(poolMutex);
+        spare.push_back(move(buffer));
+    }
+};
+
+// A day's documents, snapshotted under the book lock so rendering touches
+// only fields that never change after booking. Each document is a slice
+// of items: one bay's jobs for a work sheet, one appointment for an invoice.
+struct ReportBatch {
+    enum class Kind : uint8_t { WorkSheet, Invoice };
+
+    struct Item {
+        const ServiceAppointment* appointment;
+        string_view status;
+        int32_t start;   // work sheets: minutes after midnight
+    };
+
+    struct Document {
+        Kind kind;
+        uint32_t bay;
+        int32_t day;
+        uint32_t first;
+        uint32_t count;
+        string_view center;
+    };
+
+    vector<Document> documents;
+    vector<Item> items;
+};
+
+struct ReportStats {
+    size_t documents = 0;
+    size_t bytes = 0;
+    double milliseconds = 0;
+};
+
+// Renders a batch on a worker pool and writes the documents in batch order.
+// Documents are grouped into chunks, each rendered into a pooled buffer;
+// the caller writes finished chunks in order while later ones render. At
+// most `window` chunks are in flight, which bounds buffer memory.
+class ReportPipeline {
+private:
+    WorkerPool workers;
+    RenderBufferPool buffers;
+    size_t chunkSize;
+    size_t window;
+
+    [[gnu::format(printf, 2, 3)]] static void appendLine(string& out, const char* format, ...) {
+        // Formats straight into the output; a line longer than the first
+        // guess is formatted again once the buffer has grown to fit it
+        size_t start = out.size();
+        out.resize(start + 256);
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(&out[start], 256, format, args);
+        va_end(args);
+        if (length >= 256) {
+            out.resize(start + size_t(length) + 1);
+            va_start(args, format);
+            vsnprintf(&out[start], size_t(length) + 1, format, args);
+            va_end(args);
+        }
+        out.resize(start + size_t(max(length, 0)));
+    }
+
+    static void renderParts(string& out, const Service& service) {
+        const vector<string>& parts = service.getPartsRequired();
+        if (parts.empty()) return;
+        out += "               Parts: ";
+        for (size_t i = 0; i < parts.size(); ++i) {
+            if (i) out += ", ";
+            out += parts[i];
+        }
+        out += '\n';
+    }
+
+    static void renderWorkSheet(const ReportBatch& batch, const ReportBatch::Document& doc, string& out) {
+        string date = formatDate(doc.day);
+        appendLine(out, "==== Work sheet: %.*s bay %u, %s ====\n", int(doc.center.size()), doc.center.data(),
+                   doc.bay + 1, date.c_str());
+        int32_t booked = 0;
+        for (uint32_t i = doc.first; i < doc.first + doc.count; ++i) {
+            const ReportBatch::Item& item = batch.items[i];
+            const ServiceAppointment& apt = *item.appointment;
+            const Service& service = apt.getService();
+            int32_t minutes = service.getDurationMinutes();
+            string_view plate = apt.getVehicleNumber(), description = service.getDescription();
+            string_view client = apt.getClient().getName(), contact = apt.getClient().getContact();
+            appendLine(out, "%s-%s  %-12.*s %.*s [%.*s]\n", formatClock(item.start).c_str(),
+                       formatClock(item.start + minutes).c_str(), int(plate.size()), plate.data(),
+                       int(description.size()), description.data(), int(item.status.size()), item.status.data());
+            appendLine(out, "               Client: %.*s (%.*s)\n", int(client.size()), client.data(),
+                       int(contact.size()), contact.data());
+            renderParts(out, service);
+            booked += minutes;
+        }
+        appendLine(out, "%u jobs, %dh%02d booked\n\n", doc.count, booked / 60, booked % 60);
+    }
+
+    static void renderInvoice(const ReportBatch& batch, const ReportBatch::Document& doc, string& out) {
+        const ServiceAppointment& apt = *batch.items[doc.first].appointment;
+        const Service& service = apt.getService();
+        int year, month, day;
+        civilFromDays(doc.day, year, month, day);
+        string_view plate = apt.getVehicleNumber(), description = service.getDescription();
+        string_view client = apt.getClient().getName(), contact = apt.getClient().getContact();
+        appendLine(out, "==== Invoice INV-%04d%02d%02d-%06u, %.*s ====\n", year, month, day,
+                   apt.getHistory()->appointmentId, int(doc.center.size()), doc.center.data());
+        appendLine(out, "Date: %02d-%02d-%04d  Client: %.*s (%.*s)  Vehicle: %.*s\n", day, month, year,
+                   int(client.size()), client.data(), int(contact.size()), contact.data(), int(plate.size()),
+                   plate.data());
+        appendLine(out, "  %-48.*s %10.2f\n", int(description.size()), description.data(), service.calculateCost());
+        renderParts(out, service);
+        appendLine(out, "  %-48s %10.2f\n\n", "Amount due", service.calculateCost());
+    }
+
+public:
+    explicit ReportPipeline(size_t threads = max<size_t>(1, thread::hardware_concurrency()),
+                            size_t chunkSize = 64)
+        : workers(threads), chunkSize(max<size_t>(chunkSize, 1)), window(4 * max<size_t>(threads, 1)) {}
+
+    // write receives the output in document order; it runs on the caller's thread
+    ReportStats run(const ReportBatch& batch, const function<void(string_view)>& write) {
+        struct Chunk {
+            unique_ptr<string> text;
+            exception_ptr error;
+            bool ready = false;
+        };
+        auto start = chrono::steady_clock::now();
+        size_t chunkCount = (batch.documents.size() + chunkSize - 1) / chunkSize;
+        vector<Chunk> chunks(chunkCount);
+        mutex doneMutex;
+        condition_variable done;
+        size_t dispatched = 0;
+        ReportStats stats;
+
+        auto dispatch = [&](size_t index) {
+            chunks[index].text = buffers.acquire();
+            workers.submit([&, index] {
+                Chunk& chunk = chunks[index];
+                try {
+                    size_t last = min(batch.documents.size(), (index + 1) * chunkSize);
+                    for (size_t d = index * chunkSize; d < last; ++d) {
+                        const ReportBatch::Document& doc = batch.documents[d];
+                        if (doc.kind == ReportBatch::Kind::WorkSheet) renderWorkSheet(batch, doc, *chunk.text);
+                        else renderInvoice(batch, doc, *chunk.text);
+                    }
+                } catch (...) {
+                    chunk.error = current_exception();
+                }
+                // Notify under the lock: run() may return, destroying done,
+                // as soon as it sees the last chunk ready
+                lock_guard<mutex> lock(doneMutex);
+                chunk.ready = true;
+                done.notify_all();
+            });
+        };
+        // Waits for everything dispatched so no task outlives this frame
+        auto settle = [&] {
+            unique_lock<mutex> lock(doneMutex);
+            done.wait(lock, [&] {
+                return all_of(chunks.begin(), chunks.begin() + dispatched, [](const Chunk& c) { return c.ready; });
+            });
+        };
+
+        try {
+            for (size_t next = 0; next < chunkCount; ++next) {
+                for (; dispatched < chunkCount && dispatched < next + window; ++dispatched) dispatch(dispatched);
+                Chunk& chunk = chunks[next];
+                {
+                    unique_lock<mutex> lock(doneMutex);
+                    done.wait(lock, [&] { return chunk.ready; });
+                }
+                if (chunk.error) rethrow_exception(chunk.error);
+                write(*chunk.text);
+                stats.bytes += chunk.text->size();
+                buffers.release(move(chunk.text));
+            }
+        } catch (...) {
+            settle();
+            throw;
+        }
+        stats.documents = batch.documents.size();
+        stats.milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        return stats;
+    }
+
+    size_t threadCount() const { return workers.size(); }
+};
+
+// A backup in flight. On Linux the book is written by a forked child from
+// its copy-on-write image; elsewhere it is written synchronously.
+struct BackupHandle {
+    long child = 0;          // pid of the writer, 0 once finished or when synchronous
+    string path;
+    int64_t stallNs = 0;     // how long bookings were blocked
+    size_t appointments = 0;
+};
+
+// Service Center class
+class ServiceCenter {
+private:
+    pmr::memory_resource* resource;
+    // Per-category accounting; declared first so they outlive what they track
+    CountingResource appointmentMemory;
+    CountingResource clientMemory;
+    size_t serviceBytes = 0;
+    size_t partsBytes = 0;
+    size_t partEntries = 0;
+    pmr::vector<shared_ptr<ServiceAppointment>> appointments;
+    VehicleHistoryIndex vehicleHistory;
+    DueServiceIndex oilChangeDue;
+    AggregateTables aggregates;
+    OpsSketches sketches;
+    SearchIndex searchIndex;
+    // Clients and services live as long as the center; appointments and read
+    // paths only hold borrowed pointers, so listing does no refcounting
+    StringPool clientNames;
+    vector<shared_ptr<Client>> clients;
+    unordered_map<string, Client*> clientsByContact;
+    vector<unique_ptr<Service>> services;
+    unordered_map<string, const Service*> servicesByKey;   // see serviceKey
+    // Every workflow ever loaded stays alive for the appointments that use it
+    WorkflowActions workflowActions;
+    vector<shared_ptr<const Workflow>> loadedWorkflows;
+    array<const Workflow*, kServiceKindCount> workflowFor{};
+    // Bookable service types; readers pin a version without locking
+    RcuCell<ServiceCatalog> catalog;
+    atomic<uint64_t> catalogVersion{1};
+    unordered_map<int32_t, uint32_t> activeBookings;   // per day, excluding cancelled
+    unordered_map<int32_t, vector<uint32_t>> appointmentsByDay;   // indexes into appointments
+    size_t dailyCapacity = 0;                          // 0 means unlimited
+    BusinessCalendar calendar;                         // closures and reduced days
+    Waitlist waitlist;
+    SubscriberList observers;   // center-wide, e.g. dashboards
+    // A notification queued under the book lock; keepAlive pins a weakly
+    // held watcher until it is delivered
+    struct Notice {
+        ServiceObserver* target;
+        shared_ptr<ServiceObserver> keepAlive;
+        string message;
+    };
+    vector<Notice> outbox;      // guarded by the book lock
+    shared_mutex appointmentMutex;
+    condition_variable_any cv;
+#ifdef __linux__
+    AsyncFile* journal = nullptr;
+    SharedAppointmentStore* sharedStore = nullptr;
+#endif
+    bool isOpen;
+    bool threadConfined;
+    bool notificationsEnabled;
+
+    static unique_ptr<const ServiceCatalog> defaultCatalog() {
+        istringstream defaults(kDefaultServiceCatalog);
+        return ServiceCatalogLoader().load(defaults, 1);
+    }
+
+    // A center owned by a single runtime core skips the mutex entirely
+    unique_lock<shared_mutex> lockBook() {
+        if (threadConfined) return unique_lock<shared_mutex>(appointmentMutex, defer_lock);
+        return unique_lock<shared_mutex>(appointmentMutex);
+    }
+
+    // Listing and lookups share the book with each other
+    shared_lock<shared_mutex> readBook() {
+        if (threadConfined) return shared_lock<shared_mutex>(appointmentMutex, defer_lock);
+        return shared_lock<shared_mutex>(appointmentMutex);
+    }
+
+    void registerWorkflowActions() {
+        workflowActions.addGuard("engineWork", [](const ServiceAppointment& apt) {
+            return apt.getService().getKind() == ServiceKind::EngineRepair;
+        });
+        workflowActions.addGuard("routineWork", [](const ServiceAppointment& apt) {
+            return apt.getService().getKind() != ServiceKind::EngineRepair;
+        });
+        workflowActions.addHook("notify", [this](ServiceAppointment& apt, string_view, string_view to) {
+            if (!notificationsEnabled) return;
+            string message = "Vehicle ";
+            message += apt.getVehicleNumber();
+            message += " is now ";
+            message += to;
+            outbox.push_back({&apt.getClient(), nullptr, move(message)});
+        });
+    }
+
+    // Queues for the booking client, then everyone watching
+    void queueForAll(ServiceAppointment& apt, const string& message) {
+        outbox.push_back({&apt.getClient(), nullptr, message});
+        queueForWatchers(apt, message);
+    }
+
+    // Queues for the appointment's watchers, then center-wide observers, which
+    // get the appointment prefixed for context. Watchers are pinned until
+    // delivery.
+    void queueForWatchers(ServiceAppointment& apt, const string& message) {
+        auto queue = [&](const string& text) {
+            return [&](const shared_ptr<ServiceObserver>& observer) {
+                outbox.push_back({observer.get(), observer, text});
+            };
+        };
+        if (SubscriberList* watchers = apt.getWatchers()) watchers->forEachLive(queue(message));
+        if (observers.size()) {
+            string tagged = "[";
+            tagged += apt.getVehicleNumber();
+            tagged += ' ';
+            tagged += apt.getScheduledDate();
+            tagged += "] ";
+            tagged += message;
+            observers.forEachLive(queue(tagged));
+        }
+    }
+
+    // Releases the book lock, then delivers what was queued under it, so
+    // observer code never runs while the book is locked. Notices left by an
+    // operation that threw go out with the next delivery.
+    void deliverNotices(unique_lock<shared_mutex>& lock) {
+        vector<Notice> ready;
+        ready.swap(outbox);
+        if (lock.owns_lock()) lock.unlock();
+        for (const Notice& notice : ready) notice.target->update(notice.message);
+    }
+
+    // Prefers the live appointment over cancelled ones on the same day
+    ServiceAppointment* findAppointment(const string& vehicleNum, int32_t day) {
+        ServiceAppointment* target = nullptr;
+        vehicleHistory.forEach(vehicleNum, [&](const ServiceRecord& record) {
+            if (record.day != day) return;
+            if (!target || record.state != StateKind::Cancelled) target = appointments[record.appointmentId].get();
+        });
+        return target;
+    }
+
+    // Books with the lock already held; vehicleNum and date are canonical
+    ServiceAppointment& bookLocked(Client& client, const string& vehicleNum, const Service& service,
+                                   const string& date, int32_t day) {
+        if (calendar.isClosed(day)) throw CenterClosed(date, calendar.closureReason(day));
+        uint32_t* booked;
+        {
+            TraceSpan span("addAppointment.conflictCheck");
+            // Check for scheduling conflicts against this vehicle's own history
+            vehicleHistory.forEach(vehicleNum, [&](const ServiceRecord& record) {
+                if (record.day == day && record.state != StateKind::Cancelled) {
+                    throw SchedulingConflict();
+                }
+            });
+            booked = &activeBookings[day];
+            uint32_t capacity = calendar.capacityFor(day, uint32_t(dailyCapacity));
+            if (capacity && *booked >= capacity) {
+                throw CapacityExceeded();
+            }
+        }
+
+        TraceSpan span("addAppointment.insert");
+        // Everything that can throw happens before the book changes: a failed
+        // booking leaves no appointment without history and no inflated count
+        auto appointment = allocate_shared<ServiceAppointment>(
+            pmr::polymorphic_allocator<ServiceAppointment>(&appointmentMemory),
+            client, vehicleNum, service, date,
+            *workflowFor[static_cast<size_t>(service.getKind())], this);
+        ServiceRecord record{day, static_cast<uint32_t>(appointments.size()),
+                             static_cast<float>(service.calculateCost()),
+                             service.getKind(), StateKind::Scheduled};
+        record.state = appointment->getStateKind();
+        if (appointments.size() == appointments.capacity()) {
+            appointments.reserve(max<size_t>(16, appointments.capacity() * 2));
+        }
+        vector<uint32_t>& sameDay = appointmentsByDay[day];
+        if (sameDay.size() == sameDay.capacity()) {
+            sameDay.reserve(max<size_t>(4, sameDay.capacity() * 2));
+        }
+        vehicleHistory.reserve(vehicleNum);
+        aggregates.record(record.day, record.service, record.state, 1, record.cost);
+        searchIndex.addBooking(vehicleNum, client.getId(), client.getName());
+        sketches.bookingsByClient.add(client.getId());
+
+        // Commit; none of these throw after the reservations above
+        appointments.push_back(appointment);
+        sameDay.push_back(record.appointmentId);
+        ++*booked;
+        appointment->attachHistory(vehicleHistory.append(vehicleNum, record));
+        writeJournal('B', *appointment);
+        return *appointment;
+    }
+
+    // Fills a freed slot from the day's waitlist. Entries still blocked by
+    // their own vehicle's booking are set aside and restored afterwards, on
+    // every exit; a day that has since closed promotes no one.
+    void promoteFromWaitlist(int32_t day) {
+        vector<Waitlist::Entry> blocked;
+        Waitlist::Entry entry;
+        while (waitlist.popBest(day, entry)) {
+            string vehicleNum(entry.vehicleNumber.view());
+            string date = formatDate(day);
+            ServiceAppointment* booked;
+            try {
+                booked = &bookLocked(*entry.client, vehicleNum, *entry.service, date, day);
+            } catch (const SchedulingConflict&) {
+                blocked.push_back(entry);
+                continue;
+            } catch (const CapacityExceeded&) {
+                blocked.push_back(entry);
+                break;
+            } catch (const CenterClosed&) {
+                blocked.push_back(entry);
+                break;
+            } catch (...) {
+                waitlist.restore(entry);
+                for (const auto& waiting : blocked) waitlist.restore(waiting);
+                throw;
+            }
+            if (notificationsEnabled) {
+                queueForAll(*booked, "Waitlisted request for " + vehicleNum + " confirmed for " + date);
+            }
+            break;
+        }
+        for (const auto& waiting : blocked) waitlist.restore(waiting);
+    }
+
+    // Fires with the lock held and updates the indexes when the state moved
+    ServiceAppointment::TransitionResult fireLocked(ServiceAppointment& target, uint8_t eventId) {
+        ServiceAppointment::TransitionResult result = target.fire(eventId);
+        if (result == ServiceAppointment::TransitionResult::Applied) {
+            TraceSpan updateSpan("transition.indexes");
+            afterTransition(target, string(target.getVehicleNumber()));
+        }
+        return result;
+    }
+
+    // Appends "<kind>,<book line>" for a booking (B) or state change (T) and
+    // mirrors the appointment into shared memory
+    void writeJournal(char kind, const ServiceAppointment& apt) {
+#ifdef __linux__
+        if (sharedStore) {
+            uint32_t id = apt.getHistory()->appointmentId;
+            if (kind == 'B') sharedStore->append(id, apt);
+            else sharedStore->update(id, apt);
+        }
+        if (!journal) return;
+        char line[512];
+        line[0] = kind;
+        line[1] = ',';
+        journal->append(string_view(line, 2 + formatBookLine(apt, line + 2, sizeof(line) - 2)));
+#else
+        (void)kind;
+        (void)apt;
+#endif
+    }
+
+    // Keeps history, dashboards and indexes in step with a state change
+    void afterTransition(ServiceAppointment& target, const string& vehicleNum) {
+        writeJournal('T', target);
+        // Watchers see every transition; the client only those with hook=notify
+        if (notificationsEnabled && (target.getWatchers() || observers.size())) {
+            queueForWatchers(target, "Vehicle " + vehicleNum + " is now " + string(target.getStatus()));
+        }
+        ServiceRecord* record = target.getHistory();
+        StateKind previous = record->state;
+        record->state = target.getStateKind();
+        if (record->state == previous) return;
+        aggregates.transition(record->day, record->service, previous, record->state, record->cost);
+        if (record->state == StateKind::Cancelled) {
+            --activeBookings[record->day];
+            promoteFromWaitlist(record->day);
+        }
+        if (record->state == StateKind::Completed) {
+            if (record->service == ServiceKind::OilChange) {
+                oilChangeDue.recordCompletion(vehicleNum, record->day, &target.getClient());
+            }
+            sketches.spendByClient.add(target.getClient().getId(), record->cost);
+            if (record->day != kInvalidDay) {
+                sketches.vehiclesByMonth[monthKey(record->day)].add(hashString(vehicleNum));
+            }
+        }
+    }
+
+public:
+    explicit ServiceCenter(pmr::memory_resource* resource = pmr::get_default_resource(),
+                           bool threadConfined = false)
+        : resource(resource), appointmentMemory(resource), clientMemory(resource),
+          appointments(&appointmentMemory), clientNames(resource), catalog(defaultCatalog()), isOpen(true),
+          threadConfined(threadConfined), notificationsEnabled(true) {
+        registerWorkflowActions();
+        istringstream defaults(kDefaultWorkflowConfig);
+        loadWorkflows(defaults);
+    }
+
+    // Compiles workflow config and swaps it in for new bookings; existing
+    // appointments keep running on the workflow they were booked with
+    void loadWorkflows(istream& config) {
+        WorkflowSet set = WorkflowLoader(workflowActions).load(config);
+        auto lock = lockBook();
+        for (size_t kind = 0; kind < kServiceKindCount; ++kind) {
+            if (set.byService[kind]) workflowFor[kind] = set.byService[kind].get();
+        }
+        for (auto& workflow : set.workflows) loadedWorkflows.push_back(move(workflow));
+    }
+
+    void loadWorkflowFile(const string& path) {
+        ifstream config(path);
+        if (!config) throw runtime_error("Cannot open workflow config: " + path);
+        loadWorkflows(config);
+    }
+
+    // Parses a catalog and publishes it as the next version. Bookings that
+    // already pinned the previous version finish against it.
+    uint64_t loadServiceCatalog(istream& config) {
+        uint64_t version = catalogVersion.fetch_add(1) + 1;
+        catalog.publish(ServiceCatalogLoader().load(config, version));
+        return version;
+    }
+
+    uint64_t loadServiceCatalogFile(const string& path) {
+        ifstream config(path);
+        if (!config) throw runtime_error("Cannot open service catalog: " + path);
+        return loadServiceCatalog(config);
+    }
+
+    RcuCell<ServiceCatalog>::ReadGuard readCatalog() const { return catalog.read(); }
+
+    static constexpr const char* kBookHeader = "# vehicle,date,status,service,cost,client,contact\n";
+
+    // Formats one book line into out; returns its length, truncated to fit.
+    // Touches no heap, stdio or locale, so a forked backup child may use it.
+    static size_t formatBookLine(const ServiceAppointment& apt, char* out, size_t capacity) {
+        size_t n = 0;
+        auto put = [&](string_view text) {
+            size_t take = min(text.size(), capacity - 1 - n);
+            memcpy(out + n, text.data(), take);
+            n += take;
+        };
+        // Cost as "%.2f" would print it, for amounts a booking can carry
+        char amount[24];
+        char* end = amount + sizeof(amount);
+        char* digits = end;
+        double cost = apt.getHistory()->cost;
+        uint64_t cents = static_cast<uint64_t>(min(fabs(cost), 1e15) * 100 + 0.5);
+        for (int place = 0; place < 3 || cents; ++place, cents /= 10) {
+            if (place == 2) *--digits = '.';
+            *--digits = static_cast<char>('0' + cents % 10);
+        }
+        if (cost < 0) *--digits = '-';
+
+        put(apt.getVehicleNumber()); put(",");
+        put(apt.getScheduledDate()); put(",");
+        put(apt.getStatus()); put(",");
+        put(apt.getService().getDescription()); put(",");
+        put(string_view(digits, end - digits)); put(",");
+        put(apt.getClient().getName()); put(",");
+        put(apt.getClient().getContact()); put("\n");
+        out[n] = '\0';
+        return n;
+    }
+
+    // One line per appointment. Needs a stable book: the lock held, or the
+    // private image in a forked child.
+    void writeBook(ostream& out) const {
+        out << kBookHeader;
+        char line[512];
+        for (const auto& apt : appointments) out.write(line, formatBookLine(*apt, line, sizeof(line)));
+    }
+
+#ifdef __linux__
+    // Streams the book into an async file. Lines are formatted into a local
+    // chunk under the read lock; the disk writes happen off this thread.
+    void exportAppointments(AsyncFile& out) {
+        string chunk;
+        chunk.reserve(64 * 1024);
+        chunk += kBookHeader;
+        char line[512];
+        {
+            auto lock = readBook();
+            for (const auto& apt : appointments) {
+                chunk.append(line, formatBookLine(*apt, line, sizeof(line)));
+                if (chunk.size() >= 60 * 1024) {
+                    out.append(chunk);
+                    chunk.clear();
+                }
+            }
+        }
+        out.append(chunk);
+        out.flush();
+    }
+
+    // Journals bookings and state changes to an async file; nullptr stops it
+    void setJournal(AsyncFile* file) {
+        auto lock = lockBook();
+        journal = file;
+    }
+
+    // Mirrors the book into shared memory, starting with what is booked
+    // already; nullptr stops mirroring
+    void setSharedStore(SharedAppointmentStore* store) {
+        auto lock = lockBook();
+        sharedStore = store;
+        if (!store) return;
+        for (size_t i = 0; i < appointments.size(); ++i) store->append(static_cast<uint32_t>(i), *appointments[i]);
+    }
+#endif
+
+#ifdef __linux__
+    // writeBook for a forked child: formats into the caller's buffer and
+    // drains it with write(2), with no heap, stdio or locks
+    bool writeBookFile(const char* filePath, char* buffer, size_t capacity) const {
+        const size_t kLineBytes = 512;
+        int fd = open(filePath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) return false;
+        bool ok = true;
+        size_t used = 0;
+        auto drain = [&] {
+            for (size_t done = 0; ok && done < used;) {
+                ssize_t n = write(fd, buffer + done, used - done);
+                if (n < 0 && errno == EINTR) continue;
+                ok = n > 0;
+                done += ok ? static_cast<size_t>(n) : 0;
+            }
+            used = 0;
+        };
+        size_t header = strlen(kBookHeader);
+        memcpy(buffer, kBookHeader, header);
+        used = header;
+        for (const auto& apt : appointments) {
+            if (capacity - used < kLineBytes) drain();
+            used += formatBookLine(*apt, buffer + used, kLineBytes);
+        }
+        drain();
+        return close(fd) == 0 && ok;
+    }
+#endif
+
+    // Takes a point-in-time backup. With fork (Linux), bookings stall only
+    // while the book lock is held around fork(); the child writes path.tmp,
+    // renames it into place and exits. Call finishBackup to reap the writer.
+    // Without fork the whole dump runs under the lock.
+    BackupHandle startBackup(const string& path, bool useFork = true) {
+        BackupHandle handle;
+        handle.path = path;
+        auto lock = lockBook();
+        auto start = chrono::steady_clock::now();
+        handle.appointments = appointments.size();
+#ifdef __linux__
+        if (useFork) {
+            // Another thread may have held the heap or stdio locks at the
+            // fork, so the child only makes async-signal-safe calls; its
+            // path and output buffer are prepared here
+            string tmpPath = path + ".tmp";
+            vector<char> buffer(1 << 20);
+            cout.flush();
+            pid_t child = fork();
+            if (child == 0) {
+                bool ok = writeBookFile(tmpPath.c_str(), buffer.data(), buffer.size()) &&
+                          rename(tmpPath.c_str(), path.c_str()) == 0;
+                _exit(ok ? 0 : 1);
+            }
+            handle.stallNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+            if (child < 0) throw runtime_error("Backup fork failed");
+            handle.child = child;
+            return handle;
+        }
+#else
+        (void)useFork;
+#endif
+        {
+            ofstream out(path, ios::binary);
+            writeBook(out);
+            if (!out) throw runtime_error("Cannot write backup: " + path);
+        }
+        handle.stallNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        return handle;
+    }
+
+    // Waits for (or with wait=false, polls) the backup writer. Returns true
+    // once the backup is complete; throws if the writer failed.
+    static bool finishBackup(BackupHandle& handle, bool wait = true) {
+#ifdef __linux__
+        if (!handle.child) return true;
+        int status = 0;
+        pid_t done = waitpid(static_cast<pid_t>(handle.child), &status, wait ? 0 : WNOHANG);
+        if (done == 0) return false;
+        handle.child = 0;
+        if (done < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            throw runtime_error("Backup to " + handle.path + " failed");
+        }
+#endif
+        return true;
+    }
+
+    // Registers (or reuses) the service an entry describes
+    const Service& addCatalogService(const CatalogEntry& entry, string_view detail = {}) {
+        return addService(entry.make(detail));
+    }
+
+    void setNotificationsEnabled(bool enabled) { notificationsEnabled = enabled; }
+    size_t appointmentCount() const { return appointments.size(); }
+    size_t historyBytes() const { return vehicleHistory.bytesUsed(); }
+
+    // Returns the center's client for this contact, registering it on first
+    // use. A contact already registered under another name is rejected rather
+    // than silently booked for the existing client.
+    Client& addClient(string_view name, string_view contact) {
+        auto lock = lockBook();
+        string key(contact);
+        auto it = clientsByContact.find(key);
+        if (it != clientsByContact.end()) {
+            if (it->second->getName() != name) {
+                throw invalid_argument("Contact " + key + " is already registered to " +
+                                       string(it->second->getName()));
+            }
+            return *it->second;
+        }
+        clients.push_back(allocate_shared<Client>(pmr::polymorphic_allocator<Client>(&clientMemory), clientNames, name, contact,
+                                                  static_cast<uint32_t>(clients.size())));
+        clientsByContact.emplace(move(key), clients.back().get());
+        return *clients.back();
+    }
+
+    // Everything a booking takes from its service: two services with the
+    // same key price, schedule and describe a job identically
+    static string serviceKey(const Service& service) {
+        string key(service.getDescription());
+        double cost = service.calculateCost();
+        uint32_t skills = service.getRequiredSkills();
+        int32_t minutes = service.getDurationMinutes();
+        key += '\0';
+        key += static_cast<char>(service.getKind());
+        key.append(reinterpret_cast<const char*>(&cost), sizeof(cost));
+        key.append(reinterpret_cast<const char*>(&skills), sizeof(skills));
+        key.append(reinterpret_cast<const char*>(&minutes), sizeof(minutes));
+        for (const auto& part : service.getPartsRequired()) {
+            key += '\0';
+            key += part;
+        }
+        return key;
+    }
+
+    // Takes ownership of a service; an identical existing service is reused,
+    // so a reloaded catalog entry with new pricing gets a service of its own
+    const Service& addService(unique_ptr<Service> service) {
+        auto lock = lockBook();
+        string key = serviceKey(*service);
+        auto it = servicesByKey.find(key);
+        if (it != servicesByKey.end()) return *it->second;
+        serviceBytes += service->objectBytes();
+        partsBytes += service->partsBytes();
+        partEntries += service->getPartsRequired().size();
+        services.push_back(move(service));
+        servicesByKey.emplace(move(key), services.back().get());
+        return *services.back();
+    }
+
+    size_t clientCount() const { return clients.size(); }
+
+    // Clients that no appointment refers to, in any state
+    vector<const Client*> orphanedClients() {
+        auto lock = readBook();
+        unordered_set<const Client*> referenced;
+        for (const auto& appointment : appointments) referenced.insert(&appointment->getClient());
+        vector<const Client*> orphans;
+        for (const auto& client : clients) {
+            if (!referenced.count(client.get())) orphans.push_back(client.get());
+        }
+        return orphans;
+    }
+
+    // Live and peak bytes per object category. Services and parts lists are
+    // never freed before the center, so their peak equals their live size.
+    vector<MemoryUsage> memoryUsage() {
+        auto lock = readBook();
+        size_t history = vehicleHistory.bytesUsed();
+        return {
+            {"Appointments", appointments.size(), appointmentMemory.live(), appointmentMemory.peak()},
+            {"Clients", clients.size(), clientMemory.live(), clientMemory.peak()},
+            {"Services", services.size(), serviceBytes, serviceBytes},
+            {"Parts lists", partEntries, partsBytes, partsBytes},
+            {"History records", appointments.size(), history, history},
+            {"Client names", clientNames.uniqueValues(), clientNames.reservedBytes(), clientNames.reservedBytes()},
+        };
+    }
+
+    void viewMemory() {
+        vector<MemoryUsage> rows = memoryUsage();
+        vector<const Client*> orphans = orphanedClients();
+        size_t totalLive = 0;
+        cout << "Category            Objects    Live bytes    Peak bytes\n";
+        for (const auto& row : rows) {
+            char line[96];
+            snprintf(line, sizeof(line), "%-18s %8zu  %12zu  %12zu\n",
+                     row.category, row.objects, row.liveBytes, row.peakBytes);
+            cout << line;
+            totalLive += row.liveBytes;
+        }
+        cout << "Total live: " << totalLive << " bytes\n";
+        if (orphans.empty()) return;
+        cout << orphans.size() << " orphaned client(s) with no appointments, about "
+             << orphans.size() * clientMemory.live() / max<size_t>(clients.size(), 1) << " bytes:\n";
+        for (const Client* client : orphans) cout << "  " << client->getKey() << "\n";
+    }
+
+    // Active bookings allowed per day; 0 removes the limit
+    void setDailyCapacity(size_t perDay) {
+        auto lock = lockBook();
+        dailyCapacity = perDay;
+    }
+
+    // Replaces the business calendar; existing bookings are kept
+    void loadCalendar(istream& in) {
+        BusinessCalendar loaded = BusinessCalendarLoader().load(in);
+        auto lock = lockBook();
+        calendar = move(loaded);
+    }
+
+    // The next `count` open dates from rawFrom that still have capacity.
+    // Closed days are skipped 64 at a time by the calendar's bitmaps.
+    vector<OpenSlot> findOpenSlots(const string& rawFrom, size_t count) {
+        string from = normalizeDate(rawFrom);
+        if (from.empty()) throw invalid_argument("Invalid start date");
+        vector<OpenSlot> slots;
+        if (!count) return slots;
+        auto lock = readBook();
+        calendar.forEachOpenDay(parseDate(from), [&](int32_t day) {
+            uint32_t capacity = calendar.capacityFor(day, uint32_t(dailyCapacity));
+            auto booked = activeBookings.find(day);
+            uint32_t taken = booked == activeBookings.end() ? 0 : booked->second;
+            if (!capacity || taken < capacity) {
+                slots.push_back({day, capacity ? capacity - taken : UINT32_MAX, calendar.isReduced(day)});
+            }
+            return slots.size() < count;
+        });
+        return slots;
+    }
+
+    // Returns the booked appointment, borrowed from the center
+    ServiceAppointment& addAppointment(Client& client, const string& rawVehicleNum,
+                                       const Service& service, const string& rawDate) {
+        AllocationScope allocations(AllocationSite::AddAppointment);
+        string vehicleNum = normalizePlate(rawVehicleNum);
+        string date = normalizeDate(rawDate);
+        if (vehicleNum.empty()) throw invalid_argument("Invalid vehicle number");
+        if (date.empty()) throw invalid_argument("Invalid appointment date");
+
+        TraceSpan span("addAppointment");
+        unique_lock<shared_mutex> lock;
+        {
+            TraceSpan lockSpan("addAppointment.lock");
+            lock = lockBook();
+        }
+        ServiceAppointment& appointment = bookLocked(client, vehicleNum, service, date, parseDate(date));
+        
+        // Notify client and center-wide observers
+        if (notificationsEnabled) {
+            TraceSpan notifySpan("addAppointment.notify");
+            queueForAll(appointment, "Appointment scheduled for " + date);
+        }
+        deliverNotices(lock);
+        return appointment;
+    }
+
+    // Books like addAppointment, but a conflict or a full day puts the request
+    // on that day's waitlist instead of dropping it. Returns true if booked.
+    bool addAppointmentOrWait(Client& client, const string& rawVehicleNum,
+                              const Service& service, const string& rawDate, uint8_t priority = 1) {
+        AllocationScope allocations(AllocationSite::AddAppointment);
+        string vehicleNum = normalizePlate(rawVehicleNum);
+        string date = normalizeDate(rawDate);
+        if (vehicleNum.empty()) throw invalid_argument("Invalid vehicle number");
+        if (date.empty()) throw invalid_argument("Invalid appointment date");
+        int32_t day = parseDate(date);
+
+        auto wait = [&](const runtime_error& reason) {
+            size_t position = waitlist.add(Waitlist::Entry{priority, 0, &client, PlateString(vehicleNum),
+                                                           &service, day});
+            if (notificationsEnabled) {
+                outbox.push_back({&client, nullptr, string(reason.what()) + "; added to the waitlist for " +
+                                                        date + " (" + to_string(position) + " waiting)"});
+            }
+        };
+
+        TraceSpan span("addAppointment");
+        unique_lock<shared_mutex> lock;
+        {
+            TraceSpan lockSpan("addAppointment.lock");
+            lock = lockBook();
+        }
+        ServiceAppointment* appointment;
+        try {
+            appointment = &bookLocked(client, vehicleNum, service, date, day);
+        } catch (const SchedulingConflict& e) {
+            wait(e);
+            deliverNotices(lock);
+            return false;
+        } catch (const CapacityExceeded& e) {
+            wait(e);
+            deliverNotices(lock);
+            return false;
+        }
+        if (notificationsEnabled) {
+            TraceSpan notifySpan("addAppointment.notify");
+            queueForAll(*appointment, "Appointment scheduled for " + date);
+        }
+        deliverNotices(lock);
+        return true;
+    }
+
+    // Moves a booking to a new date; the old slot goes to that day's waitlist
+    void rescheduleAppointment(const string& rawVehicleNum, const string& rawOldDate, const string& rawNewDate) {
+        string vehicleNum = normalizePlate(rawVehicleNum);
+        string newDate = normalizeDate(rawNewDate);
+        if (newDate.empty()) throw invalid_argument("Invalid appointment date");
+        int32_t oldDay = parseDate(normalizeDate(rawOldDate));
+
+        auto lock = lockBook();
+        ServiceAppointment* current = findAppointment(vehicleNum, oldDay);
+        if (!current || current->getStateKind() != StateKind::Scheduled) {
+            throw runtime_error("No scheduled appointment found for this vehicle on this date");
+        }
+        // The cancel is checked, guard included, before anything is booked:
+        // a rejected cancel must not leave the vehicle on both dates. Guards
+        // only read the appointment, so the check still holds after booking.
+        uint8_t cancel = current->getWorkflow().eventId("cancel");
+        switch (cancel == Workflow::kNone ? ServiceAppointment::TransitionResult::NotAllowed
+                                          : current->check(cancel)) {
+        case ServiceAppointment::TransitionResult::Applied:
+            break;
+        case ServiceAppointment::TransitionResult::NotAllowed:
+            throw runtime_error("Workflow does not allow cancellation");
+        case ServiceAppointment::TransitionResult::GuardRejected:
+            throw runtime_error("Cancellation guard rejected the old appointment");
+        }
+
+        ServiceAppointment& moved = bookLocked(current->getClient(), vehicleNum, current->getService(), newDate,
+                                               parseDate(newDate));
+        current->fire(cancel);
+        afterTransition(*current, vehicleNum);
+        // Watchers follow the booking to its new date
+        if (current->getWatchers()) moved.adoptWatchers(*current);
+        if (notificationsEnabled) {
+            queueForAll(moved, "Appointment for " + vehicleNum + " moved to " + newDate);
+        }
+        deliverNotices(lock);
+    }
+
+    size_t waitlistSize() const { return waitlist.size(); }
+
+    // Observers are held weakly: dropping the last shared_ptr unsubscribes
+    void subscribe(const shared_ptr<ServiceObserver>& observer) { observers.subscribe(observer); }
+    void unsubscribe(const ServiceObserver* observer) { observers.unsubscribe(observer); }
+    size_t observerCount() const { return observers.size(); }
+
+    // Watches one appointment, e.g. for a fleet manager or insurer
+    void subscribe(const string& rawVehicleNum, const string& rawDate, const shared_ptr<ServiceObserver>& observer) {
+        string vehicleNum = normalizePlate(rawVehicleNum);
+        auto lock = lockBook();
+        ServiceAppointment* target = findAppointment(vehicleNum, parseDate(normalizeDate(rawDate)));
+        if (!target) throw runtime_error("No appointment found for this vehicle on this date");
+        target->watchers().subscribe(observer);
+    }
+
+    void unsubscribe(const string& rawVehicleNum, const string& rawDate, const ServiceObserver* observer) {
+        string vehicleNum = normalizePlate(rawVehicleNum);
+        auto lock = lockBook();
+        ServiceAppointment* target = findAppointment(vehicleNum, parseDate(normalizeDate(rawDate)));
+        if (target && target->getWatchers()) target->getWatchers()->unsubscribe(observer);
+    }
+
+    // Read-only walk over the book under a shared lock
+    template <typename Visitor>
+    void forEachAppointment(Visitor&& visit) {
+        auto lock = readBook();
+        AllocationScope allocations(AllocationSite::ListedRecord);
+        allocations.setOperations(appointments.size());
+        for (const auto& apt : appointments) visit(static_cast<const ServiceAppointment&>(*apt));
+    }
+
+    void viewAppointments() {
+        TraceSpan span("viewAppointments");
+        forEachAppointment([](const ServiceAppointment& apt) {
+            cout << "\nVehicle: " << apt.getVehicleNumber() 
+                 << "\nClient: " << apt.getClient().getName()
+                 << "\nService: " << apt.getService().getDescription()
+                 << "\nDate: " << apt.getScheduledDate()
+                 << "\nStatus: " << apt.getStatus() << endl;
+        });
+    }
+
+    // Fires a named workflow event (e.g. "checkin", "cancel") for the
+    // appointment of a vehicle on a date
+    void applyEvent(const string& rawVehicleNum, const string& rawDate, const string& event) {
+        AllocationScope allocations(AllocationSite::ProgressState);
+        string vehicleNum = normalizePlate(rawVehicleNum);
+        int32_t day = parseDate(normalizeDate(rawDate));
+        TraceSpan span("transition");
+        unique_lock<shared_mutex> lock;
+        {
+            TraceSpan lockSpan("transition.lock");
+            lock = lockBook();
+        }
+        ServiceAppointment* target = findAppointment(vehicleNum, day);
+        if (!target) {
+            throw runtime_error("No appointment found for this vehicle on this date");
+        }
+        const Workflow& workflow = target->getWorkflow();
+        uint8_t eventId = event.empty() ? workflow.nextEvent() : workflow.eventId(event);
+        if (eventId == Workflow::kNone) {
+            throw invalid_argument("Unknown workflow event: " + event);
+        }
+
+        switch (fireLocked(*target, eventId)) {
+        case ServiceAppointment::TransitionResult::NotAllowed: {
+            string message = "No '" + (event.empty() ? string("next") : event) +
+                             "' transition from " + string(target->getStatus());
+            const char* separator = " (allowed: ";
+            for (string_view name : workflow.eventsFrom(target->getState())) {
+                message += separator;
+                message += name;
+                separator = ", ";
+            }
+            if (separator[0] == ',') message += ')';
+            throw runtime_error(message);
+        }
+        case ServiceAppointment::TransitionResult::GuardRejected:
+            throw runtime_error("Transition blocked by workflow guard");
+        case ServiceAppointment::TransitionResult::Applied:
+            break;
+        }
+        deliverNotices(lock);
+    }
+
+    // Fires a workflow event on an appointment handle, skipping the lookup by
+    // vehicle and date; for drivers that keep handles, like the simulator
+    ServiceAppointment::TransitionResult advanceAppointment(ServiceAppointment& target, uint8_t eventId) {
+        AllocationScope allocations(AllocationSite::ProgressState);
+        TraceSpan span("transition");
+        auto lock = lockBook();
+        ServiceAppointment::TransitionResult result = fireLocked(target, eventId);
+        deliverNotices(lock);
+        return result;
+    }
+
+    // Advances the appointment for a vehicle on a date to its next state
+    void progressAppointment(const string& rawVehicleNum, const string& rawDate) {
+        applyEvent(rawVehicleNum, rawDate, "");
+    }
+
+    // Plans the day's scheduled and in-progress work across technicians
+    TechnicianPlan planTechnicians(int32_t day, const vector<Technician>& technicians,
+                                   AssignmentObjective objective) {
+        TechnicianPlan plan;
+        vector<AssignmentJob> jobs;
+        {
+            auto lock = readBook();
+            auto sameDay = appointmentsByDay.find(day);
+            if (sameDay != appointmentsByDay.end()) {
+                for (uint32_t index : sameDay->second) {
+                    const auto& apt = appointments[index];
+                    StateKind kind = apt->getStateKind();
+                    if (kind != StateKind::Scheduled && kind != StateKind::InProgress) continue;
+                    plan.appointments.push_back(apt.get());
+                    jobs.push_back({apt->getService().getRequiredSkills(), apt->getService().getDurationMinutes()});
+                }
+            }
+        }
+        plan.assignment = TechnicianAssigner(technicians, jobs, objective).solve();
+        return plan;
+    }
+
+    // Open jobs of a day spread over bays, longest first onto the bay that
+    // frees up earliest; each bay becomes one work sheet starting at 08:00
+    void collectWorkSheets(int32_t day, size_t bays, string_view label, ReportBatch& batch) {
+        if (!bays) throw invalid_argument("Work sheets need at least one bay");
+        vector<ReportBatch::Item> jobs;
+        {
+            auto lock = readBook();
+            auto sameDay = appointmentsByDay.find(day);
+            if (sameDay != appointmentsByDay.end()) {
+                for (uint32_t index : sameDay->second) {
+                    const auto& apt = appointments[index];
+                    StateKind kind = apt->getStateKind();
+                    if (kind != StateKind::Scheduled && kind != StateKind::InProgress) continue;
+                    jobs.push_back({apt.get(), apt->getStatus(), 0});
+                }
+            }
+        }
+        stable_sort(jobs.begin(), jobs.end(), [](const ReportBatch::Item& a, const ReportBatch::Item& b) {
+            return a.appointment->getService().getDurationMinutes() > b.appointment->getService().getDurationMinutes();
+        });
+        const int32_t opening = 8 * 60;
+        vector<vector<ReportBatch::Item>> perBay(bays);
+        priority_queue<pair<int32_t, size_t>, vector<pair<int32_t, size_t>>, greater<>> freeAt;
+        for (size_t bay = 0; bay < bays; ++bay) freeAt.push({opening, bay});
+        for (ReportBatch::Item& job : jobs) {
+            auto [clock, bay] = freeAt.top();
+            freeAt.pop();
+            job.start = clock;
+            perBay[bay].push_back(job);
+            freeAt.push({clock + job.appointment->getService().getDurationMinutes(), bay});
+        }
+        for (size_t bay = 0; bay < bays; ++bay) {
+            if (perBay[bay].empty()) continue;
+            batch.documents.push_back({ReportBatch::Kind::WorkSheet, uint32_t(bay), day, uint32_t(batch.items.size()),
+                                       uint32_t(perBay[bay].size()), label});
+            batch.items.insert(batch.items.end(), perBay[bay].begin(), perBay[bay].end());
+        }
+    }
+
+    // One invoice per appointment completed on the day
+    void collectInvoices(int32_t day, string_view label, ReportBatch& batch) {
+        auto lock = readBook();
+        auto sameDay = appointmentsByDay.find(day);
+        if (sameDay == appointmentsByDay.end()) return;
+        for (uint32_t index : sameDay->second) {
+            const auto& apt = appointments[index];
+            if (apt->getStateKind() != StateKind::Completed) continue;
+            batch.documents.push_back({ReportBatch::Kind::Invoice, 0, day, uint32_t(batch.items.size()), 1, label});
+            batch.items.push_back({apt.get(), apt->getStatus(), 0});
+        }
+    }
+
+    void viewTechnicianPlan(int32_t day, const vector<Technician>& technicians,
+                            AssignmentObjective objective) {
+        TechnicianPlan plan = planTechnicians(day, technicians, objective);
+        if (plan.appointments.empty()) {
+            cout << "No open appointments on " << formatDate(day) << endl;
+            return;
+        }
+        const Assignment& result = plan.assignment;
+        for (size_t t = 0; t < technicians.size(); ++t) {
+            cout << "\n" << technicians[t].name << " (" << formatClock(technicians[t].shiftStart) << "-"
+                 << formatClock(technicians[t].shiftEnd) << ")\n";
+            int32_t clock = technicians[t].shiftStart;
+            for (size_t j = 0; j < plan.appointments.size(); ++j) {
+                if (result.technicianFor[j] != static_cast<int32_t>(t)) continue;
+                const ServiceAppointment& apt = *plan.appointments[j];
+                int32_t end = clock + apt.getService().getDurationMinutes();
+                cout << "  " << formatClock(clock) << "-" << formatClock(end) << "  "
+                     << apt.getVehicleNumber() << "  " << apt.getService().getDescription()
+                     << (end > technicians[t].shiftEnd ? "  [overtime]" : "") << "\n";
+                clock = end;
+            }
+        }
+        for (size_t j = 0; j < plan.appointments.size(); ++j) {
+            if (result.technicianFor[j] < 0) {
+                cout << "\nUnassigned (no qualified technician): " << plan.appointments[j]->getVehicleNumber() << "\n";
+            }
+        }
+        cout << "\nLatest finish: " << formatClock(result.makespan) << ", overtime: " << result.overtime
+             << " min" << (result.optimal ? " (optimal)" : "") << endl;
+    }
+
+    void viewDashboard(int32_t fromDay, int32_t toDay) {
+        vector<pair<int32_t, DayAggregates>> rows;
+        {
+            auto lock = readBook();
+            rows = aggregates.query(fromDay, toDay);
+        }
+        if (rows.empty()) {
+            cout << "No bookings in this period" << endl;
+            return;
+        }
+        for (const auto& row : rows) {
+            cout << "\n" << formatDate(row.first) << endl;
+            for (size_t service = 0; service < kServiceKindCount; ++service) {
+                for (size_t state = 0; state < kStateKindCount; ++state) {
+                    const AggregateCell& cell = row.second[service * kStateKindCount + state];
+                    if (cell.count == 0) continue;
+                    cout << "  " << serviceKindName(static_cast<ServiceKind>(service))
+                         << " / " << stateKindName(static_cast<StateKind>(state))
+                         << ": " << cell.count << " booking(s), revenue " << cell.revenue << endl;
+                }
+            }
+        }
+    }
+
+    // Approximate top clients and distinct vehicles served in the month and year of `day`
+    void viewOpsBoard(int32_t day, size_t topN = 5) {
+        OpsSketches merged;
+        vector<pair<string, SpaceSavingTopK::Counter>> byBookings, bySpend;
+        {
+            // Sketches count client ids; resolve them to labels while the book is pinned
+            auto lock = readBook();
+            merged.merge(sketches);
+            for (const auto& c : merged.bookingsByClient.top(topN)) byBookings.emplace_back(clients[c.key]->getKey(), c);
+            for (const auto& c : merged.spendByClient.top(topN)) bySpend.emplace_back(clients[c.key]->getKey(), c);
+        }
+
+        cout << "\nTop clients by bookings:" << endl;
+        for (const auto& [label, c] : byBookings) {
+            cout << "  " << label << ": ~" << c.count << " (+/- " << c.error << ")" << endl;
+        }
+        cout << "Top clients by spend:" << endl;
+        for (const auto& [label, c] : bySpend) {
+            cout << "  " << label << ": ~" << c.count << " (+/- " << c.error << ")" << endl;
+        }
+
+        int32_t month = monthKey(day);
+        int32_t firstMonth = month - month % 12;
+        HyperLogLog year;
+        double thisMonth = 0.0;
+        for (auto it = merged.vehiclesByMonth.lower_bound(firstMonth);
+             it != merged.vehiclesByMonth.end() && it->first < firstMonth + 12; ++it) {
+            year.merge(it->second);
+            if (it->first == month) thisMonth = it->second.estimate();
+        }
+        cout << "Distinct vehicles served this month: ~" << llround(thisMonth)
+             << ", this year: ~" << llround(year.estimate()) << endl;
+    }
+
+    void search(const string& query) {
+        auto lock = readBook();
+        cout << "\nVehicles:" << endl;
+        for (const auto& match : searchIndex.findPlates(query)) {
+            cout << "  " << match.plate << " (" << match.visits << " booking(s))" << endl;
+        }
+        cout << "Clients:" << endl;
+        for (const auto& match : searchIndex.findClients(query)) {
+            cout << "  " << match.name << " (match " << llround(match.score * 100) << "%)" << endl;
+        }
+    }
+
+    // Daily job: notifies each client once for all of their vehicles now due
+    size_t notifyDueOilChanges(int32_t today) {
+        vector<DueNotice> due;
+        {
+            auto lock = lockBook();
+            due = oilChangeDue.popDue(today);
+        }
+        unordered_map<Client*, vector<const DueNotice*>> byClient;
+        for (const auto& notice : due) byClient[notice.client].push_back(&notice);
+
+        if (notificationsEnabled) {
+            for (const auto& batch : byClient) {
+                string message = "Oil change due for";
+                for (const DueNotice* notice : batch.second) {
+                    message += " " + notice->vehicleNumber + " (since " + formatDate(notice->dueDay) + ")";
+                }
+                batch.first->update(message);
+            }
+        }
+        return due.size();
+    }
+
+    void viewVehicleHistory(const string& rawVehicleNum) {
+        string vehicleNum = normalizePlate(rawVehicleNum);
+        auto lock = readBook();
+        auto records = vehicleHistory.timeline(vehicleNum);
+        if (records.empty()) {
+            cout << "No service history for " << rawVehicleNum << endl;
+            return;
+        }
+        for (const auto& record : records) {
+            auto& apt = appointments[record.appointmentId];
+            cout << "\n" << apt->getScheduledDate()
+                 << " | " << apt->getService().getDescription()
+                 << " | " << apt->getStatus()
+                 << " | Cost: " << record.cost << endl;
+        }
+    }
+};
+
+// Booking channels, highest priority first; the value doubles as waitlist priority
+enum class PriorityClass : uint8_t { Fleet, WalkIn, Web };
+constexpr size_t kPriorityClassCount = 3;
+
+inline const char* priorityClassName(PriorityClass priority) {
+    static const char* const names[kPriorityClassCount] = {"fleet", "walk-in", "web"};
+    return names[static_cast<size_t>(priority)];
+}
+
+// Thrown when a request is shed; retryAfter tells the caller when to come back
+class AdmissionRejected : public runtime_error {
+public:
+    chrono::milliseconds retryAfter;
+
+    AdmissionRejected(PriorityClass priority, chrono::milliseconds retryAfter)
+        : runtime_error(string("Too many ") + priorityClassName(priority) +
+                        " bookings right now; retry in " + to_string(retryAfter.count()) + " ms"),
+          retryAfter(retryAfter) {}
+};
+
+// Lock-free token bucket in GCRA form: one atomic "theoretical arrival time".
+// A request is admitted while that time runs less than `burst` intervals ahead.
+class TokenBucket {
+private:
+    atomic<int64_t> theoreticalArrival{0};
+    int64_t intervalNs;
+    int64_t toleranceNs;
+
+public:
+    TokenBucket(double ratePerSecond, double burst)
+        : intervalNs(ratePerSecond > 0 ? static_cast<int64_t>(1e9 / ratePerSecond) : 0),
+          toleranceNs(static_cast<int64_t>(intervalNs * max(0.0, burst - 1.0))) {}
+
+    // Returns 0 when admitted, otherwise nanoseconds until a token is available
+    int64_t tryAcquire(int64_t nowNs) {
+        if (intervalNs == 0) return 0;
+        int64_t tat = theoreticalArrival.load(memory_order_relaxed);
+        while (true) {
+            int64_t start = max(tat, nowNs);
+            if (start - nowNs > toleranceNs) return start - nowNs - toleranceNs;
+            if (theoreticalArrival.compare_exchange_weak(tat, start + intervalNs, memory_order_relaxed)) return 0;
+        }
+    }
+};
+
+// Per-class admission policy: a rate limit plus a cap on requests in flight
+struct AdmissionPolicy {
+    double ratePerSecond;   // 0 disables the rate limit
+    double burst;
+    int maxInFlight;        // 0 disables the concurrency cap
+};
+
+// Sits in front of ServiceCenter and sheds excess traffic per priority class
+// before it reaches the book lock, so queues stay short for fleet bookings
+class AdmissionController {
+private:
+    struct Lane {
+        TokenBucket bucket;
+        atomic<int> inFlight{0};
+        atomic<uint64_t> admitted{0};
+        atomic<uint64_t> rejected{0};
+        int maxInFlight;
+
+        explicit Lane(const AdmissionPolicy& policy)
+            : bucket(policy.ratePerSecond, policy.burst), maxInFlight(policy.maxInFlight) {}
+    };
+
+    array<unique_ptr<Lane>, kPriorityClassCount> lanes;
+
+    static int64_t nowNs() {
+        return chrono::duration_cast<chrono::nanoseconds>(
+                   chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+public:
+    // Releases the in-flight slot when the admitted request finishes
+    class Ticket {
+    private:
+        atomic<int>* inFlight;
+
+    public:
+        explicit Ticket(atomic<int>* inFlight) : inFlight(inFlight) {}
+        Ticket(Ticket&& other) noexcept : inFlight(other.inFlight) { other.inFlight = nullptr; }
+        Ticket(const Ticket&) = delete;
+        Ticket& operator=(const Ticket&) = delete;
+        ~Ticket() {
+            if (inFlight) inFlight->fetch_sub(1, memory_order_release);
+        }
+    };
+
+    explicit AdmissionController(const array<AdmissionPolicy, kPriorityClassCount>& policies = {{
+        {0, 0, 0},        // fleet contracts are never shed
+        {200, 50, 4},     // walk-in
+        {100, 20, 2},     // web
+    }}) {
+        for (size_t i = 0; i < kPriorityClassCount; ++i) lanes[i] = make_unique<Lane>(policies[i]);
+    }
+
+    Ticket admit(PriorityClass priority) {
+        Lane& lane = *lanes[static_cast<size_t>(priority)];
+        int inFlight = lane.inFlight.fetch_add(1, memory_order_acquire);
+        if (lane.maxInFlight && inFlight >= lane.maxInFlight) {
+            lane.inFlight.fetch_sub(1, memory_order_release);
+            lane.rejected.fetch_add(1, memory_order_relaxed);
+            throw AdmissionRejected(priority, chrono::milliseconds(1));
+        }
+
+        int64_t waitNs = lane.bucket.tryAcquire(nowNs());
+        if (waitNs > 0) {
+            lane.inFlight.fetch_sub(1, memory_order_release);
+            lane.rejected.fetch_add(1, memory_order_relaxed);
+            throw AdmissionRejected(priority, chrono::milliseconds(waitNs / 1000000 + 1));
+        }
+        lane.admitted.fetch_add(1, memory_order_relaxed);
+        return Ticket(&lane.inFlight);
+    }
+
+    uint64_t admittedCount(PriorityClass priority) const {
+        return lanes[static_cast<size_t>(priority)]->admitted.load(memory_order_relaxed);
+    }
+
+    uint64_t rejectedCount(PriorityClass priority) const {
+        return lanes[static_cast<size_t>(priority)]->rejected.load(memory_order_relaxed);
+    }
+};
+
+// Admission-controlled entry point for bookings
+class BookingGateway {
+private:
+    ServiceCenter& center;
+    AdmissionController& admission;
+
+public:
+    BookingGateway(ServiceCenter& center, AdmissionController& admission)
+        : center(center), admission(admission) {}
+
+    // Throws AdmissionRejected when shed; otherwise books or waitlists
+    bool book(PriorityClass priority, Client& client, const string& vehicleNum,
+              const Service& service, const string& date) {
+        auto ticket = admission.admit(priority);
+        return center.addAppointmentOrWait(client, vehicleNum, service, date,
+                                           static_cast<uint8_t>(priority));
+    }
+};
+
+// Bounded single-producer/single-consumer ring used to hand requests to a core
+template <typename T>
+class SpscQueue {
+private:
+    vector<T> slots;
+    size_t mask;
+    alignas(64) atomic<size_t> head{0};   // advanced by the consumer
+    alignas(64) atomic<size_t> tail{0};   // advanced by the producer
+    alignas(64) size_t cachedHead = 0;    // producer's last view of head
+    alignas(64) size_t cachedTail = 0;    // consumer's last view of tail
+
+public:
+    explicit SpscQueue(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    bool tryPush(T&& item) {
+        size_t t = tail.load(memory_order_relaxed);
+        if (t - cachedHead > mask) {
+            cachedHead = head.load(memory_order_acquire);
+            if (t - cachedHead > mask) return false;
+        }
+        slots[t & mask] = move(item);
+        tail.store(t + 1, memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& out) {
+        size_t h = head.load(memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(memory_order_acquire);
+            if (h == cachedTail) return false;
+        }
+        out = move(slots[h & mask]);
+        head.store(h + 1, memory_order_release);
+        return true;
+    }
+};
+
+// A unit of work routed to the core that owns the target center
+struct CenterRequest {
+    size_t centerId = 0;
+    function<void(ServiceCenter&)> task;
+};
+
+// Shared-nothing runtime: each core owns a disjoint set of centers, its own
+// pool allocator and one SPSC inbox per producer, so the hot path takes no locks
+class CenterRuntime {
+private:
+    struct Core {
+        pmr::unsynchronized_pool_resource arena;
+        vector<unique_ptr<ServiceCenter>> centers;
+        vector<unique_ptr<SpscQueue<CenterRequest>>> inbox;
+        thread worker;
+        atomic<uint64_t> processed{0};
+        atomic<uint64_t> failed{0};
+    };
+
+    vector<unique_ptr<Core>> cores;
+    size_t centerCount;
+    atomic<bool> running{true};
+    atomic<size_t> readyCores{0};
+
+    static void pinCurrentThread(size_t cpu) {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu % CPU_SETSIZE, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+        (void)cpu;
+#endif
+    }
+
+    void runCore(size_t index) {
+        Core& core = *cores[index];
+        pinCurrentThread(index);
+
+        // Centers are built on their owning core so their memory is first touched there
+        for (size_t id = index; id < centerCount; id += cores.size()) {
+            core.centers.push_back(make_unique<ServiceCenter>(&core.arena, true));
+            core.centers.back()->setNotificationsEnabled(false);
+        }
+        readyCores.fetch_add(1, memory_order_release);
+
+        CenterRequest request;
+        while (true) {
+            // Read before the pass: once stop is seen, only a whole pass that
+            // finds every inbox empty may end the loop
+            bool stopping = !running.load(memory_order_acquire);
+            bool didWork = false;
+            for (auto& queue : core.inbox) {
+                while (queue->tryPop(request)) {
+                    didWork = true;
+                    try {
+                        request.task(*core.centers[request.centerId / cores.size()]);
+                    } catch (const exception&) {
+                        core.failed.fetch_add(1, memory_order_relaxed);
+                    }
+                    core.processed.fetch_add(1, memory_order_relaxed);
+                }
+            }
+            if (!didWork) {
+                if (stopping) break;
+                this_thread::yield();
+            }
+        }
+    }
+
+public:
+    CenterRuntime(size_t centerCount, size_t producerCount,
+                  size_t coreCount = thread::hardware_concurrency(),
+                  size_t queueCapacity = 4096)
+        : centerCount(centerCount) {
+        if (coreCount == 0) coreCount = 1;
+        if (producerCount == 0) throw invalid_argument("Runtime needs at least one producer");
+        for (size_t i = 0; i < coreCount; ++i) {
+            auto core = make_unique<Core>();
+            for (size_t p = 0; p < producerCount; ++p) {
+                core->inbox.push_back(make_unique<SpscQueue<CenterRequest>>(queueCapacity));
+            }
+            cores.push_back(move(core));
+        }
+        for (size_t i = 0; i < coreCount; ++i) {
+            cores[i]->worker = thread(&CenterRuntime::runCore, this, i);
+        }
+        while (readyCores.load(memory_order_acquire) < coreCount) this_thread::yield();
+    }
+
+    ~CenterRuntime() { stop(); }
+
+    CenterRuntime(const CenterRuntime&) = delete;
+    CenterRuntime& operator=(const CenterRuntime&) = delete;
+
+    size_t coreCount() const { return cores.size(); }
+    size_t coreFor(size_t centerId) const { return centerId % cores.size(); }
+
+    // Each producer thread must use its own producerId so every inbox keeps one writer
+    bool trySubmit(size_t producerId, size_t centerId, function<void(ServiceCenter&)> task) {
+        if (centerId >= centerCount) throw out_of_range("Unknown service center");
+        CenterRequest request{centerId, move(task)};
+        return cores[coreFor(centerId)]->inbox.at(producerId)->tryPush(move(request));
+    }
+
+    void submit(size_t producerId, size_t centerId, function<void(ServiceCenter&)> task) {
+        if (centerId >= centerCount) throw out_of_range("Unknown service center");
+        CenterRequest request{centerId, move(task)};
+        auto& queue = *cores[coreFor(centerId)]->inbox.at(producerId);
+        while (!queue.tryPush(move(request))) this_thread::yield();
+    }
+
+    // Drains every inbox and joins the workers
+    void stop() {
+        running.store(false, memory_order_release);
+        for (auto& core : cores) {
+            if (core->worker.joinable()) core->worker.join();
+        }
+    }
+
+    uint64_t processedCount() const {
+        uint64_t total = 0;
+        for (const auto& core : cores) total += core->processed.load(memory_order_relaxed);
+        return total;
+    }
+
+    uint64_t failedCount() const {
+        uint64_t total = 0;
+        for (const auto& core : cores) total += core->failed.load(memory_order_relaxed);
+        return total;
+    }
+};
+
+// Parameters for a simulated branch
+struct SimulationConfig {
+    int32_t days = 365;
+    size_t bays = 8;
+    double bookingsPerDay = 60.0;
+    double engineShare = 0.2;       // fraction of bookings that are engine repairs
+    double noShowRate = 0.05;       // booked vehicles that never arrive
+    int32_t maxLeadDays = 14;       // bookings land 1..maxLeadDays ahead
+    int32_t openMinute = 8 * 60;
+    int32_t closeMinute = 18 * 60;
+    size_t clientCount = 5000;
+    size_t dailyCapacity = 0;       // 0 leaves the center unlimited
+    uint32_t seed = 1;
+    string workflowFile;            // site workflows; empty keeps the built-in one
+};
+
+struct SimulationReport {
+    uint64_t events = 0;
+    uint64_t bookingRequests = 0;
+    uint64_t booked = 0;
+    uint64_t rejected = 0;          // conflicts and full days
+    uint64_t noShows = 0;
+    uint64_t completed = 0;
+    double revenue = 0;
+    array<double, kServiceKindCount> revenueByService{};
+    double utilization = 0;         // busy bay-minutes over open bay-minutes
+    double meanWaitMinutes = 0;
+    int64_t p95WaitMinutes = 0;
+    int64_t maxWaitMinutes = 0;
+    double wallSeconds = 0;
+};
+
+// Discrete-event simulation of one branch. Time is virtual (minutes since
+// the first simulated midnight) and advances from event to event through a
+// min-heap; bookings and state changes go through a real ServiceCenter with
+// notifications off, so costs, capacity rules and workflows are the
+// production ones. The center is confined to the simulating thread, so it
+// skips the book lock and allocates from an unsynchronized pool.
+//
+// Throughput is bounded by that center work, about a million events per
+// second on one core; the bare event queue runs ten times faster (see
+// --bench simulate), so a year of a busy branch still takes well under a
+// second.
+class ServiceCenterSimulator {
+private:
+    // A no-show is drawn at booking but only becomes one at the arrival time
+    enum class EventType : uint8_t { BookingRequest, VehicleArrival, NoShow, ServiceDone };
+
+    struct Event {
+        int64_t time;
+        uint64_t sequence;   // FIFO among simultaneous events
+        EventType type;
+        uint32_t job;
+    };
+
+    struct Later {
+        bool operator()(const Event& a, const Event& b) const {
+            return a.time != b.time ? a.time > b.time : a.sequence > b.sequence;
+        }
+    };
+
+    struct Job {
+        ServiceAppointment* appointment;
+        int64_t arrival;
+    };
+
+    SimulationConfig config;
+    pmr::unsynchronized_pool_resource memory;
+    ServiceCenter center;
+    const Service* oil;
+    const Service* engine;
+    vector<Client*> clients;
+    vector<string> plates;           // one vehicle per client
+    vector<string> dates;            // formatted simulated days
+    vector<Job> jobs;
+    priority_queue<Event, vector<Event>, Later> events;
+    queue<uint32_t> waiting;         // arrived vehicles with no free bay
+    size_t freeBays;
+    uint64_t nextSequence = 0;
+    int64_t busyMinutes = 0;
+    vector<int64_t> waits;
+    mt19937_64 rng;
+    int32_t firstDay = daysFromCivil(2025, 1, 1);
+
+    void schedule(int64_t time, EventType type, uint32_t job = 0) {
+        events.push({time, nextSequence++, type, job});
+    }
+
+    double uniform() { return (rng() >> 11) * 0x1.0p-53; }
+
+    // Fires the workflow's next event until the appointment reaches kind;
+    // site workflows may pass through several states on the way, but a
+    // visit never takes more steps than the workflow has states
+    void advanceTo(ServiceAppointment& apt, StateKind kind) {
+        const Workflow& workflow = apt.getWorkflow();
+        for (size_t step = 0; step < workflow.stateCount() && apt.getStateKind() != kind; ++step) {
+            if (center.advanceAppointment(apt, workflow.nextEvent()) != ServiceAppointment::TransitionResult::Applied) {
+                break;
+            }
+        }
+    }
+
+    void startService(uint32_t job, int64_t now) {
+        ServiceAppointment& apt = *jobs[job].appointment;
+        advanceTo(apt, StateKind::InProgress);
+        int64_t wait = now - jobs[job].arrival;
+        waits.push_back(wait);
+        int32_t duration = apt.getService().getDurationMinutes();
+        busyMinutes += duration;
+        --freeBays;
+        schedule(now + duration, EventType::ServiceDone, job);
+    }
+
+    void onBookingRequest(int64_t now, SimulationReport& report) {
+        schedule(now + static_cast<int64_t>(-log(1.0 - uniform()) * 1440.0 / config.bookingsPerDay),
+                 EventType::BookingRequest);
+        int32_t day = static_cast<int32_t>(now / 1440) + 1 + static_cast<int32_t>(rng() % config.maxLeadDays);
+        if (day >= config.days) return;   // past the simulated period
+        ++report.bookingRequests;
+        size_t clientIndex = rng() % clients.size();
+        const Service& service = uniform() < config.engineShare ? *engine : *oil;
+        try {
+            ServiceAppointment& apt = center.addAppointment(*clients[clientIndex], plates[clientIndex],
+                                                            service, dates[day]);
+            ++report.booked;
+            int32_t window = config.closeMinute - config.openMinute;
+            int64_t arrival = int64_t(day) * 1440 + config.openMinute + static_cast<int64_t>(uniform() * window * 0.8);
+            jobs.push_back({&apt, arrival});
+            schedule(arrival, uniform() < config.noShowRate ? EventType::NoShow : EventType::VehicleArrival,
+                     static_cast<uint32_t>(jobs.size() - 1));
+        } catch (const runtime_error&) {
+            ++report.rejected;
+        }
+    }
+
+    void onVehicleArrival(uint32_t job, int64_t now) {
+        if (freeBays) startService(job, now);
+        else waiting.push(job);
+    }
+
+    // The slot is held until the vehicle fails to turn up; workflows
+    // without a noshow event cancel instead
+    void onNoShow(uint32_t job, SimulationReport& report) {
+        ServiceAppointment& apt = *jobs[job].appointment;
+        const Workflow& workflow = apt.getWorkflow();
+        uint8_t event = workflow.eventId("noshow");
+        if (event == Workflow::kNone) event = workflow.eventId("cancel");
+        if (event != Workflow::kNone &&
+            center.advanceAppointment(apt, event) == ServiceAppointment::TransitionResult::Applied) {
+            ++report.noShows;
+        }
+    }
+
+    void onServiceDone(uint32_t job, int64_t now, SimulationReport& report) {
+        ServiceAppointment& apt = *jobs[job].appointment;
+        advanceTo(apt, StateKind::Completed);
+        double cost = apt.getService().calculateCost();
+        report.revenue += cost;
+        report.revenueByService[static_cast<size_t>(apt.getService().getKind())] += cost;
+        ++report.completed;
+        ++freeBays;
+        if (!waiting.empty()) {
+            uint32_t next = waiting.front();
+            waiting.pop();
+            startService(next, now);
+        }
+    }
+
+public:
+    explicit ServiceCenterSimulator(const SimulationConfig& config)
+        : config(config), center(&memory, true), freeBays(config.bays), rng(config.seed) {
+        if (config.days <= 0 || config.bays == 0 || config.bookingsPerDay <= 0 || config.maxLeadDays <= 0) {
+            throw invalid_argument("Simulation needs positive days, bays, booking rate and lead time");
+        }
+        if (!config.workflowFile.empty()) center.loadWorkflowFile(config.workflowFile);
+        center.setNotificationsEnabled(false);
+        center.setDailyCapacity(config.dailyCapacity);
+        oil = &center.addService(make_unique<OilChange>());
+        engine = &center.addService(make_unique<EngineRepair>("Simulated engine work"));
+        for (size_t i = 0; i < config.clientCount; ++i) {
+            clients.push_back(&center.addClient("Sim client " + to_string(i), to_string(9000000000ULL + i)));
+            plates.push_back("SIM" + to_string(i));
+        }
+        for (int32_t day = 0; day < config.days; ++day) dates.push_back(formatDate(firstDay + day));
+    }
+
+    SimulationReport run() {
+        SimulationReport report;
+        auto start = chrono::steady_clock::now();
+        schedule(0, EventType::BookingRequest);
+        int64_t horizon = int64_t(config.days) * 1440;
+        while (!events.empty()) {
+            Event event = events.top();
+            events.pop();
+            // Requests stop at the horizon; vehicles already booked are served
+            if (event.type == EventType::BookingRequest && event.time >= horizon) continue;
+            ++report.events;
+            switch (event.type) {
+            case EventType::BookingRequest: onBookingRequest(event.time, report); break;
+            case EventType::VehicleArrival: onVehicleArrival(event.job, event.time); break;
+            case EventType::NoShow: onNoShow(event.job, report); break;
+            case EventType::ServiceDone: onServiceDone(event.job, event.time, report); break;
+            }
+        }
+        report.wallSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        double openBayMinutes = double(config.days) * config.bays * (config.closeMinute - config.openMinute);
+        report.utilization = busyMinutes / openBayMinutes;
+        if (!waits.empty()) {
+            double total = 0;
+            for (int64_t w : waits) total += w;
+            report.meanWaitMinutes = total / waits.size();
+            size_t p95 = waits.size() * 95 / 100;
+            nth_element(waits.begin(), waits.begin() + p95, waits.end());
+            report.p95WaitMinutes = waits[p95];
+            report.maxWaitMinutes = *max_element(waits.begin(), waits.end());
+        }
+        return report;
+    }
+};
+
+inline void printSimulationReport(const SimulationConfig& config, const SimulationReport& report) {
+    cout << "Simulated " << config.days << " days, " << config.bays << " bays, "
+         << config.bookingsPerDay << " booking requests/day\n"
+         << "Requests: " << report.bookingRequests << ", booked: " << report.booked
+         << ", rejected: " << report.rejected << ", no-shows: " << report.noShows
+         << ", completed: " << report.completed << "\n"
+         << "Bay utilization: " << report.utilization * 100 << "%\n"
+         << "Wait for a bay: mean " << report.meanWaitMinutes << " min, p95 " << report.p95WaitMinutes
+         << " min, max " << report.maxWaitMinutes << " min\n"
+         << "Revenue: " << llround(report.revenue);
+    for (size_t kind = 0; kind < kServiceKindCount; ++kind) {
+        cout << (kind ? ", " : " (") << serviceKindName(static_cast<ServiceKind>(kind)) << " "
+             << llround(report.revenueByService[kind]);
+    }
+    cout << ")\n"
+         << report.events << " events in " << report.wallSeconds * 1000 << " ms ("
+         << report.events / max(report.wallSeconds, 1e-9) / 1e6 << " M events/s)\n";
+}
+
+// Benchmarks - run with: --bench <name>
+void benchmarkRuntime() {
+    const size_t centers = 256;
+    const size_t bookingsPerCenter = 200;
+    size_t maxCores = max<size_t>(1, thread::hardware_concurrency());
+    vector<size_t> coreCounts;
+    for (size_t n = 1; n < maxCores; n *= 2) coreCounts.push_back(n);
+    coreCounts.push_back(maxCores);
+
+    // Per-center client and service, registered by an untimed setup task on
+    // the owning core; booking tasks only capture two pointers, which
+    // std::function stores inline
+    struct Fixture {
+        Client* client = nullptr;
+        const Service* service = nullptr;
+    };
+    vector<string> plates(centers * bookingsPerCenter);
+    for (size_t c = 0; c < centers; ++c) {
+        for (size_t i = 0; i < bookingsPerCenter; ++i) {
+            plates[c * bookingsPerCenter + i] = "KA" + to_string(c) + "X" + to_string(i);
+        }
+    }
+
+    for (size_t coreCount : coreCounts) {
+        size_t producers = coreCount;
+        CenterRuntime runtime(centers, producers, coreCount);
+        vector<Fixture> fixtures(centers);
+
+        auto setupStart = chrono::steady_clock::now();
+        for (size_t c = 0; c < centers; ++c) {
+            Fixture* fixture = &fixtures[c];
+            runtime.submit(c % producers, c, [fixture, c](ServiceCenter& center) {
+                fixture->client = &center.addClient("Bench " + to_string(c), "98450" + to_string(10000 + c));
+                fixture->service = &center.addService(make_unique<OilChange>());
+            });
+        }
+        while (runtime.processedCount() < centers) this_thread::yield();
+        double setupMs = chrono::duration<double, milli>(chrono::steady_clock::now() - setupStart).count();
+
+        auto start = chrono::steady_clock::now();
+        vector<thread> feeders;
+        for (size_t p = 0; p < producers; ++p) {
+            feeders.emplace_back([&, p] {
+                for (size_t c = p; c < centers; c += producers) {
+                    Fixture* fixture = &fixtures[c];
+                    for (size_t i = 0; i < bookingsPerCenter; ++i) {
+                        const string* plate = &plates[c * bookingsPerCenter + i];
+                        runtime.submit(p, c, [fixture, plate](ServiceCenter& center) {
+                            center.addAppointment(*fixture->client, *plate, *fixture->service, "01-01-2025");
+                        });
+                    }
+                }
+            });
+        }
+        for (auto& feeder : feeders) feeder.join();
+        runtime.stop();
+
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        uint64_t bookings = runtime.processedCount() - centers;
+        cout << coreCount << " core(s): " << bookings << " bookings in " << seconds * 1000 << " ms ("
+             << bookings / seconds << " ops/s, " << runtime.failedCount() << " failed); setup of "
+             << centers << " centers " << setupMs << " ms\n";
+    }
+}
+
+void benchmarkSketches() {
+    const size_t updates = 2000000;
+    const size_t clients = 10000;
+    OpsSketches ops;
+    uint64_t rng = 88172645463325252ull;
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < updates; ++i) {
+        rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+        // Skewed client popularity so the heavy hitters are meaningful
+        size_t pick = (rng % 100 < 80) ? rng % 100 : rng % clients;
+        ops.bookingsByClient.add(pick);
+    }
+    double topKNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / updates;
+
+    HyperLogLog hll;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < updates; ++i) hll.add(hashString(to_string(i % 1000000)));
+    double hllNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / updates;
+
+    cout << "Space-Saving update: " << topKNs << " ns\n"
+         << "HyperLogLog update (incl. hashing): " << hllNs << " ns, estimate "
+         << llround(hll.estimate()) << " of 1000000 distinct\n";
+}
+
+void benchmarkSearch() {
+    const size_t records = 1000000;
+    SearchIndex index;
+    static const char* const syllables[] = {"ar", "jun", "pri", "ya", "ra", "vi", "mee", "na", "su", "resh",
+                                            "ka", "vya", "an", "il", "div", "ku", "mar", "shar", "ma", "red",
+                                            "dy", "ny", "ir", "rao", "gup", "ta", "me", "non", "sri", "lak"};
+    auto syllableName = [&](size_t seed) {
+        string part;
+        for (int k = 0; k < 3; ++k, seed /= 30) part += syllables[seed % 30];
+        part[0] = static_cast<char>(toupper(part[0]));
+        return part;
+    };
+
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < records; ++i) {
+        char plate[16];
+        snprintf(plate, sizeof(plate), "KA%02zu%c%c%04zu", i % 60, char('A' + i % 26),
+                 char('A' + (i / 26) % 26), (i * 7919) % 10000);
+        // The name depends only on i % 27000, which serves as the client id
+        string name = syllableName(i % 27000) + " " + syllableName((i * 7919) % 27000);
+        index.addBooking(plate, static_cast<uint32_t>(i % 27000), name);
+    }
+    double buildMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    const int queries = 1000;
+    start = chrono::steady_clock::now();
+    size_t hits = 0;
+    for (int q = 0; q < queries; ++q) hits += index.findPlates("KA" + to_string(q % 60)).size();
+    double prefixUs = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / queries;
+
+    start = chrono::steady_clock::now();
+    for (int q = 0; q < queries; ++q) hits += index.findClients(syllableName(q * 31) + " " + syllableName(q * 97).substr(1)).size();
+    double fuzzyUs = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / queries;
+
+    cout << records << " bookings indexed in " << buildMs << " ms\n"
+         << "Plate prefix query: " << prefixUs << " us\n"
+         << "Fuzzy name query: " << fuzzyUs << " us (" << hits << " hits)\n";
+}
+
+void benchmarkNormalization() {
+    const size_t records = 1000000;
+    vector<BookingFields> rows(records);
+    for (size_t i = 0; i < records; ++i) {
+        rows[i].clientName = "  Client " + to_string(i) + " ";
+        rows[i].contact = "+91 98450-" + to_string(10000 + i % 90000);
+        rows[i].vehicleNumber = "ka " + to_string(10 + i % 90) + " ab " + to_string(1000 + i % 9000);
+        rows[i].date = to_string(1 + i % 28) + "/" + to_string(1 + i % 12) + "/2025";
+    }
+    rows[7].date = "31-02-2025";
+
+    auto start = chrono::steady_clock::now();
+    auto errors = normalizeBookings(rows);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    size_t rejected = count_if(errors.begin(), errors.end(), [](uint8_t e) { return e != 0; });
+
+    // Valid plates only (at most kMaxPlateLength once normalized): as typed at
+    // the desk, and already canonical as stored. A small set is replayed so
+    // the kernel, not memory, is measured.
+    vector<string> typed(4096), stored(4096);
+    for (size_t i = 0; i < typed.size(); ++i) {
+        typed[i] = (i % 2 ? "ka " : "KA-") + to_string(10 + i % 90) + " ab " + to_string(1000 + i % 9000);
+        stored[i] = "KA" + to_string(10 + i % 90) + "AB" + to_string(1000 + i % 9000);
+    }
+    string out(64, '\0');
+    size_t total = 0;
+    auto plateRate = [&](const vector<string>& plates) {
+        auto begin = chrono::steady_clock::now();
+        for (size_t done = 0; done < records; done += plates.size())
+            for (const auto& plate : plates) total += normalizePlateInto(plate, &out[0]);
+        return records / chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    };
+    double typedRate = plateRate(typed);
+    double storedRate = plateRate(stored);
+
+    cout << "Booking normalization: " << records / seconds << " records/s ("
+         << rejected << " rejected)\n"
+         << "Plate kernel, typed (13 bytes): " << typedRate << " records/s\n"
+         << "Plate kernel, canonical (10 bytes): " << storedRate << " records/s ("
+         << total << " bytes)\n";
+}
+
+// Multi-threaded listing throughput: borrowed references versus copying a
+// shared_ptr per record, as getClient() used to
+void benchmarkReaders() {
+    const size_t bookings = 20000;
+    const int passes = 50;
+    ServiceCenter center;
+    center.setNotificationsEnabled(false);
+    const Service& oil = center.addService(make_unique<OilChange>());
+    StringPool names;
+    vector<shared_ptr<Client>> sharedClients;
+    vector<shared_ptr<Client>> byAppointment;
+    for (size_t i = 0; i < 16; ++i) {
+        sharedClients.push_back(make_shared<Client>(names, "Popular client " + to_string(i), "98450" + to_string(10000 + i)));
+    }
+    for (size_t i = 0; i < bookings; ++i) {
+        Client& client = center.addClient("Popular client " + to_string(i % 16), "98450" + to_string(10000 + i % 16));
+        center.addAppointment(client, "KA01AB" + to_string(i), oil, "01-01-2025");
+        byAppointment.push_back(sharedClients[i % 16]);
+    }
+
+    auto run = [&](size_t threads, bool borrowed) {
+        atomic<size_t> total{0};
+        auto start = chrono::steady_clock::now();
+        vector<thread> readers;
+        for (size_t t = 0; t < threads; ++t) {
+            readers.emplace_back([&] {
+                size_t sum = 0;
+                for (int pass = 0; pass < passes; ++pass) {
+                    size_t index = 0;
+                    center.forEachAppointment([&](const ServiceAppointment& apt) {
+                        if (borrowed) {
+                            sum += apt.getClient().getName().size();
+                        } else {
+                            shared_ptr<Client> client = byAppointment[index];
+                            sum += client->getName().size();
+                        }
+                        ++index;
+                    });
+                }
+                total += sum;
+            });
+        }
+        for (auto& reader : readers) reader.join();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        return threads * passes * bookings / seconds;
+    };
+
+    size_t maxThreads = max<size_t>(1, thread::hardware_concurrency());
+    for (size_t threads = 1;; threads = min(threads * 2, maxThreads)) {
+        double shared = run(threads, false);
+        double borrowed = run(threads, true);
+        cout << threads << " reader(s): shared_ptr copies " << shared << " records/s, borrowed "
+             << borrowed << " records/s (" << borrowed / shared << "x)\n";
+        if (threads == maxThreads) break;
+    }
+}
+
+// Fleet booking latency while web traffic floods the center, with and without
+// admission control in front of it
+void benchmarkAdmission() {
+    const int fleetBookings = 2000;
+    const size_t webThreads = 4;
+
+    auto run = [&](bool controlled) {
+        ServiceCenter center;
+        center.setNotificationsEnabled(false);
+        AdmissionController admission;
+        BookingGateway gateway(center, admission);
+        const Service& oil = center.addService(make_unique<OilChange>());
+        Client& fleet = center.addClient("Fleet contract", "9845000001");
+        Client& web = center.addClient("Web customer", "9845000002");
+        atomic<bool> done{false};
+        atomic<uint64_t> webAttempts{0};
+
+        vector<thread> flood;
+        for (size_t t = 0; t < webThreads; ++t) {
+            flood.emplace_back([&, t] {
+                for (uint64_t i = 0; !done.load(memory_order_relaxed); ++i) {
+                    string plate = "WB" + to_string(t) + "X" + to_string(i);
+                    string date = formatDate(daysFromCivil(2025, 1, 1) + static_cast<int32_t>(i % 365));
+                    webAttempts.fetch_add(1, memory_order_relaxed);
+                    try {
+                        if (controlled) gateway.book(PriorityClass::Web, web, plate, oil, date);
+                        else center.addAppointmentOrWait(web, plate, oil, date, 2);
+                    } catch (const AdmissionRejected&) {
+                        this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        vector<double> latencies;
+        for (int i = 0; i < fleetBookings; ++i) {
+            string plate = "FL" + to_string(i);
+            string date = formatDate(daysFromCivil(2025, 1, 1) + i % 365);
+            auto start = chrono::steady_clock::now();
+            if (controlled) gateway.book(PriorityClass::Fleet, fleet, plate, oil, date);
+            else center.addAppointmentOrWait(fleet, plate, oil, date, 0);
+            latencies.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - start).count());
+            this_thread::sleep_for(chrono::microseconds(100));
+        }
+        done = true;
+        for (auto& t : flood) t.join();
+
+        sort(latencies.begin(), latencies.end());
+        cout << (controlled ? "With admission control:    " : "Without admission control: ")
+             << "fleet p50 " << latencies[latencies.size() / 2] << " us, p99 "
+             << latencies[latencies.size() * 99 / 100] << " us, max " << latencies.back()
+             << " us; web attempts " << webAttempts.load() << ", web admitted "
+             << (controlled ? admission.admittedCount(PriorityClass::Web) : webAttempts.load()) << "\n";
+    };
+    run(false);
+    run(true);
+}
+
+// Bytes-per-appointment report for the appointment book itself
+void benchmarkMemory() {
+    const size_t bookings = 100000;
+    CountingResource counting;
+    {
+        ServiceCenter center(&counting);
+        center.setNotificationsEnabled(false);
+        vector<Client*> clients;
+        for (size_t i = 0; i < 1000; ++i) {
+            clients.push_back(&center.addClient("Client number " + to_string(i), "98450" + to_string(10000 + i)));
+        }
+        const Service& oil = center.addService(make_unique<OilChange>());
+        const Service& engine = center.addService(make_unique<EngineRepair>("Cylinder head gasket replacement"));
+        for (size_t i = 0; i < bookings; ++i) {
+            string plate = "KA" + to_string(10 + i % 90) + "AB" + to_string(i);
+            string date = formatDate(daysFromCivil(2025, 1, 1) + static_cast<int32_t>(i % 365));
+            center.addAppointment(*clients[i % clients.size()], plate, i % 4 ? oil : engine, date);
+        }
+        vector<MemoryUsage> usage = center.memoryUsage();
+        const MemoryUsage& names = usage.back();
+
+        cout << "sizeof(ServiceAppointment): " << sizeof(ServiceAppointment) << " bytes\n"
+             << "sizeof(Client): " << sizeof(Client) << " bytes\n"
+             << "sizeof(ServiceRecord): " << sizeof(ServiceRecord) << " bytes\n"
+             << "Appointment book: " << double(usage[0].liveBytes) / bookings
+             << " bytes/appointment (" << counting.allocations() << " allocations for " << bookings
+             << " bookings and " << clients.size() << " clients)\n"
+             << "Vehicle history: " << double(center.historyBytes()) / bookings << " bytes/appointment\n"
+             << "Client names: " << names.liveBytes << " bytes for " << names.objects << " unique values\n";
+    }
+}
+
+// Cost of an instrumented booking with tracing off and on
+void benchmarkTracing() {
+    const size_t bookings = 200000;
+    for (bool on : {false, true}) {
+        ServiceCenter center;
+        center.setNotificationsEnabled(false);
+        const Service& oil = center.addService(make_unique<OilChange>());
+        Client& client = center.addClient("Trace client", "9845000003");
+        tracer().setEnabled(on);
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < bookings; ++i) {
+            center.addAppointment(client, "TR" + to_string(i), oil, "01-01-2025");
+        }
+        double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / bookings;
+        tracer().setEnabled(false);
+        cout << "Tracing " << (on ? "on:  " : "off: ") << ns << " ns per addAppointment\n";
+    }
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < 10000000; ++i) TraceSpan span("disabled");
+    cout << "Disabled span: " << chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / 1e7
+         << " ns\n";
+}
+
+// Quality vs time for the technician assigner on synthetic days
+void benchmarkAssignment() {
+    // The same seed per size, so both objectives see the same day
+    auto makeDay = [](size_t jobCount, size_t techCount, vector<Technician>& techs, vector<AssignmentJob>& jobs) {
+        mt19937 rng(static_cast<uint32_t>(jobCount));
+        techs.clear();
+        jobs.clear();
+        const uint32_t skillSets[] = {kSkillLubrication, kSkillEngine, kSkillLubrication | kSkillEngine};
+        for (size_t t = 0; t < techCount; ++t) {
+            int32_t start = (8 + static_cast<int32_t>(t % 3)) * 60;
+            techs.push_back({"T" + to_string(t), skillSets[t % 3], start, start + 8 * 60});
+        }
+        for (size_t j = 0; j < jobCount; ++j) {
+            bool engine = rng() % 4 == 0;
+            jobs.push_back({engine ? kSkillEngine : kSkillLubrication,
+                            engine ? 90 + static_cast<int32_t>(rng() % 211) : 20 + static_cast<int32_t>(rng() % 26)});
+        }
+    };
+    struct Size {
+        size_t jobs;
+        size_t techs;
+    };
+    const Size sizes[] = {{10, 3}, {14, 4}, {100, 16}, {500, 80}};
+    for (AssignmentObjective objective : {AssignmentObjective::Makespan, AssignmentObjective::Overtime}) {
+        cout << (objective == AssignmentObjective::Makespan ? "Minimize makespan\n" : "Minimize overtime\n");
+        for (const Size& size : sizes) {
+            vector<Technician> techs;
+            vector<AssignmentJob> jobs;
+            makeDay(size.jobs, size.techs, techs, jobs);
+            TechnicianAssigner assigner(techs, jobs, objective);
+            auto timed = [](auto&& fn, double& ms) {
+                auto start = chrono::steady_clock::now();
+                auto result = fn();
+                ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                return result;
+            };
+            double greedyMs, searchMs, exactMs = 0;
+            Assignment greedy = timed([&] { return assigner.greedy(); }, greedyMs);
+            Assignment improved = timed([&] { return assigner.solve(false); }, searchMs);
+            auto report = [](const char* label, const Assignment& a, double ms) {
+                char line[128];
+                snprintf(line, sizeof(line), "    %-14s makespan %s  overtime %5d min  %8.3f ms%s\n", label,
+                         formatClock(a.makespan).c_str(), a.overtime, ms, a.optimal ? "  (optimal)" : "");
+                cout << line;
+            };
+            cout << "  " << size.jobs << " jobs, " << size.techs << " technicians\n";
+            report("greedy", greedy, greedyMs);
+            report("+local search", improved, searchMs);
+            if (size.jobs <= TechnicianAssigner::kExactJobLimit) {
+                Assignment exact = timed([&] { return assigner.solve(true); }, exactMs);
+                report("+exact", exact, exactMs);
+            }
+            if (size.jobs == 500) {
+                cout << "    500-job day " << (searchMs < 100.0 ? "within" : "OVER") << " the 100 ms target\n";
+            }
+        }
+    }
+}
+
+#ifdef __linux__
+// Write throughput of the async backends against a blocking ofstream
+void benchmarkAsyncIo() {
+    const size_t lines = 4000000;
+    const string path = "/tmp/async-io.bench";
+    vector<string> samples;
+    for (size_t i = 0; i < 1024; ++i) {
+        samples.push_back("KA" + to_string(10 + i % 90) + "AB" + to_string(1000 + i) + "," +
+                          formatDate(daysFromCivil(2025, 1, 1) + int32_t(i % 365)) +
+                          ",Scheduled,Standard Oil Change Service,50.00,Client number " + to_string(i) +
+                          ",98450" + to_string(10000 + i) + "\n");
+    }
+    // syscalls < 0: not counted (the stream's writes happen inside libstdc++)
+    auto report = [&](const char* label, double producerMs, double totalMs, uint64_t bytes, int64_t syscalls) {
+        char line[200];
+        snprintf(line, sizeof(line), "%-26s %8.1f MiB/s  producer busy %7.1f ms  total %7.1f ms  %8s syscalls\n",
+                 label, bytes / 1048576.0 / (totalMs / 1000), producerMs, totalMs,
+                 syscalls < 0 ? "n/a" : to_string(syscalls).c_str());
+        cout << line;
+    };
+
+    {
+        uint64_t bytes = 0;
+        auto start = chrono::steady_clock::now();
+        ofstream out(path, ios::binary);
+        for (size_t i = 0; i < lines; ++i) {
+            const string& text = samples[i % samples.size()];
+            out.write(text.data(), text.size());
+            bytes += text.size();
+        }
+        double producerMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        out.close();
+        double totalMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        report("ofstream", producerMs, totalMs, bytes, -1);
+    }
+    for (AsyncIoMode mode : {AsyncIoMode::ThreadPool, AsyncIoMode::IoUring}) {
+        unique_ptr<AsyncIo> io;
+        try {
+            io = make_unique<AsyncIo>(mode);
+        } catch (const exception& e) {
+            cout << "io_uring unavailable: " << e.what() << "\n";
+            continue;
+        }
+        auto start = chrono::steady_clock::now();
+        AsyncFile out(*io, path);
+        for (size_t i = 0; i < lines; ++i) out.append(samples[i % samples.size()]);
+        out.flush();
+        double producerMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        out.close();
+        double totalMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        report(io->io().name(), producerMs, totalMs, out.bytesWritten(),
+               static_cast<int64_t>(io->io().syscallCount()));
+    }
+    remove(path.c_str());
+}
+#endif
+
+#ifdef __linux__
+// Reporting-process side of --shm: lists the live book from shared memory
+int printSharedStore(const string& name) {
+    try {
+        SharedAppointmentView view(name);
+        array<size_t, kStateKindCount> byState{};
+        double revenue = 0;
+        view.forEach([&](const SharedAppointment& apt) {
+            char cost[32];
+            snprintf(cost, sizeof(cost), "%.2f", apt.cost);
+            cout << apt.vehicle << "," << apt.date << "," << apt.status << "," << apt.service << "," << cost << ","
+                 << apt.client << "," << apt.contact << "\n";
+            ++byState[static_cast<size_t>(apt.state)];
+            if (apt.state == StateKind::Completed) revenue += apt.cost;
+        });
+        char total[32];
+        snprintf(total, sizeof(total), "%.2f", revenue);
+        cerr << view.size() << " appointments (epoch " << view.epoch() << ", writer "
+             << (view.writerAlive() ? "running" : "gone") << "): " << byState[size_t(StateKind::Scheduled)]
+             << " scheduled, " << byState[size_t(StateKind::InProgress)] << " in progress, "
+             << byState[size_t(StateKind::Completed)] << " completed, revenue " << total << "\n";
+        if (view.dropped()) cerr << view.dropped() << " bookings did not fit in the segment\n";
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
+
+// A forked reader scans the shared book while the parent books and progresses
+void benchmarkSharedStore() {
+    const size_t count = 1000000;
+    const string name = "/service-center-bench";
+    ServiceCenter center;
+    center.setNotificationsEnabled(false);
+    const Service& oil = center.addService(make_unique<OilChange>());
+    const Service& engine = center.addService(make_unique<EngineRepair>("Gearbox overhaul"));
+    vector<Client*> clients;
+    for (size_t i = 0; i < 1000; ++i) {
+        clients.push_back(&center.addClient("Shared client " + to_string(i), "98480" + to_string(10000 + i)));
+    }
+    SharedAppointmentStore store(name, count);
+    center.setSharedStore(&store);
+
+    pid_t reader = fork();
+    if (reader == 0) {
+        SharedAppointmentView view(name);
+        size_t scans = 0, records = 0, completed = 0;
+        auto start = chrono::steady_clock::now();
+        while (view.writerAlive() && view.size() < count) {
+            view.forEach([&](const SharedAppointment& apt) {
+                completed += apt.state == StateKind::Completed;
+                records += !apt.vehicle.empty();
+            });
+            ++scans;
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        printf("Reader process: %zu scans, %.1f M records/s while the writer ran (%zu completed seen)\n", scans,
+               records / seconds / 1e6, completed);
+        fflush(stdout);
+        _exit(0);
+    }
+
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        ServiceAppointment& apt = center.addAppointment(*clients[i % clients.size()], "SH" + to_string(i),
+                                                        i % 4 ? oil : engine,
+                                                        formatDate(daysFromCivil(2025, 1, 1) + int32_t(i / 5000)));
+        if (i % 3 == 0) center.advanceAppointment(apt, apt.getWorkflow().nextEvent());
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Writer: " << count << " bookings mirrored at " << count / seconds / 1e6 << " M/s\n";
+    int status;
+    waitpid(reader, &status, 0);
+
+    SharedAppointmentView view(name);
+    size_t inProgress = 0;
+    start = chrono::steady_clock::now();
+    view.forEach([&](const SharedAppointment& apt) { inProgress += apt.state == StateKind::InProgress; });
+    seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Quiescent scan: " << view.size() << " records in " << seconds * 1000 << " ms, " << inProgress
+         << " in progress (expected " << (count + 2) / 3 << ")\n";
+}
+#endif
+
+// Booking stall for a fork-based backup vs. dumping under the book lock
+void benchmarkBackup(size_t count) {
+    const size_t vehicles = 100000;
+    ServiceCenter center;
+    center.setNotificationsEnabled(false);
+    const Service& oil = center.addService(make_unique<OilChange>());
+    const Service& engine = center.addService(make_unique<EngineRepair>("Turbocharger rebuild"));
+    vector<Client*> clients;
+    vector<string> plates;
+    for (size_t i = 0; i < 10000; ++i) {
+        clients.push_back(&center.addClient("Backup client " + to_string(i), "98470" + to_string(10000 + i)));
+    }
+    for (size_t v = 0; v < vehicles; ++v) plates.push_back("BK" + to_string(10 + v % 90) + "X" + to_string(v));
+    vector<string> dates;
+    for (size_t d = 0; d * vehicles < count; ++d) dates.push_back(formatDate(daysFromCivil(2025, 1, 1) + int32_t(d)));
+
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        center.addAppointment(*clients[i % clients.size()], plates[i % vehicles], i % 5 ? oil : engine,
+                              dates[i / vehicles]);
+    }
+    cout << "Booked " << center.appointmentCount() << " appointments in "
+         << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s\n";
+
+    const string path = "/tmp/appointments.backup";
+    start = chrono::steady_clock::now();
+    BackupHandle handle = center.startBackup(path);
+    ServiceCenter::finishBackup(handle);
+    double total = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    ifstream written(path, ios::binary | ios::ate);
+    cout << "Fork backup: bookings stalled " << handle.stallNs / 1e6 << " ms; child wrote "
+         << written.tellg() / 1048576 << " MiB in " << total << " ms\n";
+
+    // Baseline: write the book while holding the lock
+    BackupHandle locked = center.startBackup(path, false);
+    cout << "Locked dump: bookings stalled " << locked.stallNs / 1e6 << " ms\n";
+    remove(path.c_str());
+}
+
+// Day-start work sheets and day-end invoices for many centers, rendered
+// with 1, 2 and 4 worker threads; output must be identical each time
+void benchmarkReports() {
+    const size_t centerCount = 8;
+    const size_t perCenter = 20000;
+    const size_t otherDays = 30, perOtherDay = 2000;   // rest of the book, never reported
+    const int32_t day = daysFromCivil(2026, 3, 2);
+    const string date = formatDate(day);
+    vector<unique_ptr<ServiceCenter>> centers;
+    vector<string> labels;
+    ReportBatch batch;
+    for (size_t c = 0; c < centerCount; ++c) {
+        centers.push_back(make_unique<ServiceCenter>());
+        ServiceCenter& center = *centers.back();
+        center.setNotificationsEnabled(false);
+        labels.push_back("Branch " + to_string(c + 1));
+        const Service& oil = center.addService(make_unique<OilChange>());
+        const Service& engine = center.addService(make_unique<EngineRepair>("Cylinder head gasket"));
+        for (size_t i = 0; i < perCenter; ++i) {
+            Client& client = center.addClient("Report client " + to_string(i % 5000), "98490" + to_string(10000 + i % 5000));
+            ServiceAppointment& apt = center.addAppointment(client, "RP" + to_string(c) + "X" + to_string(i),
+                                                            i % 3 ? oil : engine, date);
+            // Half finish during the day and get invoices
+            if (i % 2) {
+                center.advanceAppointment(apt, apt.getWorkflow().nextEvent());
+                center.advanceAppointment(apt, apt.getWorkflow().nextEvent());
+            }
+        }
+        for (size_t d = 1; d <= otherDays; ++d) {
+            string other = formatDate(day + int32_t(d));
+            for (size_t i = 0; i < perOtherDay; ++i) {
+                Client& client = center.addClient("Report client " + to_string(i % 5000), "98490" + to_string(10000 + i % 5000));
+                center.addAppointment(client, "RP" + to_string(c) + "D" + to_string(d) + "X" + to_string(i), oil, other);
+            }
+        }
+    }
+    // Collection reads only the day's index entries, so the other days in
+    // the book do not slow it down
+    auto collectStart = chrono::steady_clock::now();
+    for (size_t c = 0; c < centerCount; ++c) {
+        centers[c]->collectWorkSheets(day, 40, labels[c], batch);
+        centers[c]->collectInvoices(day, labels[c], batch);
+    }
+    double collectMs = chrono::duration<double, milli>(chrono::steady_clock::now() - collectStart).count();
+    auto emptyStart = chrono::steady_clock::now();
+    ReportBatch none;
+    for (size_t c = 0; c < centerCount; ++c) {
+        centers[c]->collectWorkSheets(day - 1, 40, labels[c], none);
+        centers[c]->collectInvoices(day - 1, labels[c], none);
+    }
+    double emptyMs = chrono::duration<double, milli>(chrono::steady_clock::now() - emptyStart).count();
+    cout << batch.documents.size() << " documents from " << centerCount << " centers, collected in "
+         << collectMs << " ms from a book of " << centerCount * (perCenter + otherDays * perOtherDay)
+         << " appointments; an empty day takes " << emptyMs << " ms\n";
+    // Rendering speeds up only with more cores than one; on fewer cores
+    // than threads the runs show the pipeline overhead instead
+    unsigned cores = max(1u, thread::hardware_concurrency());
+    cout << cores << " core" << (cores == 1 ? "" : "s") << " available\n";
+
+    size_t reference = 0;
+    double referenceMs = 0;
+    for (size_t threads : {1, 2, 4}) {
+        ReportPipeline pipeline(threads);
+        size_t digest = 0;
+#ifdef __linux__
+        AsyncIo io;
+        AsyncFile out(io, "/tmp/reports.bench");
+        ReportStats stats = pipeline.run(batch, [&](string_view text) {
+            digest = digest * 31 + hash<string_view>()(text);
+            out.append(text);
+        });
+        out.close();
+#else
+        ofstream out("/tmp/reports.bench", ios::binary);
+        ReportStats stats = pipeline.run(batch, [&](string_view text) {
+            digest = digest * 31 + hash<string_view>()(text);
+            out.write(text.data(), text.size());
+        });
+#endif
+        if (threads == 1) reference = digest;
+        char line[160];
+        if (threads == 1) referenceMs = stats.milliseconds;
+        snprintf(line, sizeof(line), "%zu threads: %8.1f ms, %6.0f documents/s, %.1f MiB, %.2fx%s%s\n", threads,
+                 stats.milliseconds, stats.documents / (stats.milliseconds / 1000), stats.bytes / 1048576.0,
+                 referenceMs / stats.milliseconds, threads > cores ? " (more threads than cores)" : "",
+                 digest == reference ? "" : "  OUTPUT DIFFERS");
+        cout << line;
+    }
+    remove("/tmp/reports.bench");
+}
+
+// Open-day checks and next-open-day search: bitmap scan vs. testing day by day
+void benchmarkCalendar() {
+    BusinessCalendar calendar;
+    calendar.setWeeklyClosures(1 << 0 | 1 << 6);   // weekends
+    mt19937 rng(7);
+    int32_t first = daysFromCivil(2025, 1, 1), last = daysFromCivil(2035, 1, 1);
+    for (int32_t day = first; day < last; ++day) {
+        if (rng() % 25 == 0) calendar.addHoliday(day, "");
+        else if (rng() % 40 == 0) calendar.addReducedDay(day, "");
+    }
+    // A long refurbishment closure
+    for (int32_t day = daysFromCivil(2030, 3, 1); day < daysFromCivil(2030, 9, 1); ++day) calendar.addHoliday(day, "");
+
+    const size_t queries = 200000;
+    vector<int32_t> starts(queries);
+    for (auto& day : starts) day = first + int32_t(rng() % uint32_t(last - first - 800));
+    starts[0] = daysFromCivil(2030, 3, 1);
+
+    auto time = [](auto&& body) {
+        auto start = chrono::steady_clock::now();
+        body();
+        return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+    };
+    size_t open = 0;
+    double checkNs = time([&] {
+        for (int32_t day : starts) open += !calendar.isClosed(day);
+    }) / queries;
+
+    const size_t wanted = 30;
+    uint64_t bitmapSum = 0, naiveSum = 0;
+    double bitmapNs = time([&] {
+        for (int32_t day : starts) {
+            for (int32_t found : calendar.nextOpenDays(day, wanted)) bitmapSum += found;
+        }
+    }) / queries;
+    double naiveNs = time([&] {
+        for (int32_t day : starts) {
+            size_t found = 0;
+            for (int32_t d = day; found < wanted; ++d) {
+                if (!calendar.isClosed(d)) {
+                    naiveSum += d;
+                    ++found;
+                }
+            }
+        }
+    }) / queries;
+    const size_t gapQueries = 10000;
+    double gapBitmapNs = time([&] {
+        for (size_t i = 0; i < gapQueries; ++i) bitmapSum += calendar.nextOpenDays(starts[0], 1)[0];
+    }) / gapQueries;
+    double gapNaiveNs = time([&] {
+        for (size_t i = 0; i < gapQueries; ++i) {
+            int32_t d = starts[0];
+            while (calendar.isClosed(d)) ++d;
+            naiveSum += d;
+        }
+    }) / gapQueries;
+
+    char line[160];
+    snprintf(line, sizeof(line), "isClosed: %.1f ns (%zu of %zu open)\n", checkNs, open, queries);
+    cout << line;
+    snprintf(line, sizeof(line), "next %zu open days: bitmap %.0f ns, day by day %.0f ns\n", wanted, bitmapNs,
+             naiveNs);
+    cout << line;
+    snprintf(line, sizeof(line), "across a 184-day closure: bitmap %.0f ns, day by day %.0f ns%s\n", gapBitmapNs,
+             gapNaiveNs, bitmapSum == naiveSum ? "" : "  MISMATCH");
+    cout << line;
+}
+
+// Transition notifications through the copy-on-write subscriber list vs. a
+// mutex-guarded list, while observers keep subscribing and going away
+void benchmarkObservers() {
+    struct CountingObserver : ServiceObserver {
+        atomic<size_t> received{0};
+        void update(const string&) override { received.fetch_add(1, memory_order_relaxed); }
+    };
+    struct LockedList {
+        mutex listMutex;
+        vector<weak_ptr<ServiceObserver>> entries;
+        void subscribe(const shared_ptr<ServiceObserver>& observer) {
+            lock_guard<mutex> lock(listMutex);
+            entries.push_back(observer);
+        }
+        void notify(const string& message) {
+            lock_guard<mutex> lock(listMutex);
+            for (auto it = entries.begin(); it != entries.end();) {
+                if (auto observer = it->lock()) {
+                    observer->update(message);
+                    ++it;
+                } else {
+                    it = entries.erase(it);
+                }
+            }
+        }
+    };
+    const size_t notifiers = 3;
+    const size_t perThread = 500000;
+    const string message = "Vehicle KA01AB1234 is now In Progress";
+
+    auto run = [&](const char* label, auto& list) {
+        vector<shared_ptr<CountingObserver>> permanent;
+        for (size_t i = 0; i < 8; ++i) {
+            permanent.push_back(make_shared<CountingObserver>());
+            list.subscribe(permanent.back());
+        }
+        // Short-lived dashboards: the first notifier subscribes one every
+        // churnEvery notifications and lets it go, so both lists see the
+        // same churn however the scheduler treats them
+        const size_t churnEvery = 1000;
+        vector<thread> threads;
+        auto start = chrono::steady_clock::now();
+        for (size_t t = 0; t < notifiers; ++t) {
+            threads.emplace_back([&, t] {
+                for (size_t i = 0; i < perThread; ++i) {
+                    if (t == 0 && i % churnEvery == 0) list.subscribe(make_shared<CountingObserver>());
+                    list.notify(message);
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        size_t delivered = 0;
+        for (const auto& observer : permanent) delivered += observer->received;
+        list.notify(message);   // prunes whatever expired last
+        cout << label << ": " << seconds * 1e9 / (notifiers * perThread) << " ns per notify, "
+             << perThread / churnEvery << " transient observers expired, " << delivered << " of "
+             << 8 * notifiers * perThread << " permanent deliveries\n";
+    };
+
+    // With one core the notifiers never contend, so both lists cost about
+    // the same; the copy-on-write list pulls ahead once they run in parallel
+    unsigned cores = max(1u, thread::hardware_concurrency());
+    cout << notifiers << " notifiers on " << cores << " core" << (cores == 1 ? "" : "s") << "\n";
+    SubscriberList lockFree;
+    run("Copy-on-write list", lockFree);
+    cout << "  entries left after pruning: " << lockFree.size() << ", retired snapshots not yet freed: "
+         << rcuDomain().pendingReclaim() << "\n";
+    LockedList locked;
+    run("Mutex-guarded list", locked);
+}
+
+// Catalog lookups from reader threads while a writer keeps republishing
+void benchmarkCatalog() {
+    ServiceCenter center;
+    const size_t readers = 3;
+    const size_t readsPerThread = 2000000;
+    atomic<bool> done{false};
+    atomic<size_t> inconsistent{0};
+    size_t reloads = 0;
+
+    thread writer([&] {
+        while (!done.load(memory_order_relaxed)) {
+            istringstream config(kDefaultServiceCatalog);
+            center.loadServiceCatalog(config);
+            ++reloads;
+            this_thread::sleep_for(chrono::microseconds(200));
+        }
+    });
+    auto start = chrono::steady_clock::now();
+    vector<thread> threads;
+    for (size_t r = 0; r < readers; ++r) {
+        threads.emplace_back([&] {
+            for (size_t i = 0; i < readsPerThread; ++i) {
+                auto catalog = center.readCatalog();
+                const CatalogEntry* oil = catalog->find("oil");
+                const CatalogEntry* engine = catalog->find("engine");
+                // Both lookups must come from the same pinned version
+                if (!oil || !engine || oil->baseCost != 50 || catalog->all().size() != 2) {
+                    inconsistent.fetch_add(1, memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() /
+                (readers * readsPerThread);
+    done = true;
+    writer.join();
+    cout << readers << " readers: " << ns << " ns per pinned lookup pair, " << reloads
+         << " catalog versions published, " << inconsistent.load() << " inconsistent reads\n";
+}
+
+// Simulation throughput on a ten-year, high-volume branch
+void benchmarkSimulation() {
+    SimulationConfig config;
+    config.days = 3650;
+    config.bays = 16;
+    config.bookingsPerDay = 120;
+    SimulationReport report = ServiceCenterSimulator(config).run();
+    printSimulationReport(config, report);
+
+    // The same number of events through a bare heap of the same shape:
+    // the gap to the line above is the center's work, not the event loop
+    struct Event {
+        int64_t time;
+        uint64_t sequence;
+        uint32_t job;
+        bool operator>(const Event& other) const {
+            return time != other.time ? time > other.time : sequence > other.sequence;
+        }
+    };
+    priority_queue<Event, vector<Event>, greater<>> events;
+    mt19937_64 rng(config.seed);
+    uint64_t sequence = 0, popped = 0;
+    for (size_t i = 0; i < 4096; ++i) events.push({int64_t(rng() % 20000), sequence++, 0});
+    auto start = chrono::steady_clock::now();
+    while (popped < report.events) {
+        Event event = events.top();
+        events.pop();
+        events.push({event.time + int64_t(rng() % 20000), sequence++, uint32_t(popped++)});
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Event queue alone: " << popped / seconds / 1e6 << " M events/s\n";
+}
+
+// Allocation budgets per hot-path operation, measured on the workload below
+// with some headroom. Raise them only alongside the change that needs it.
+struct AllocationBudget {
+    AllocationSite site;
+    double allocations;
+    double bytes;
+};
+
+constexpr AllocationBudget kAllocationBudgets[] = {
+    {AllocationSite::AddAppointment, 16.0, 900.0},
+    {AllocationSite::ProgressState, 3.5, 200.0},
+    {AllocationSite::ListedRecord, 0.0, 0.0},
+};
+
+// Prints one site's measured cost per operation against its budget; false
+// when over
+bool checkAllocationBudget(const AllocationBudget& budget) {
+    AllocationProfile::Totals totals = allocationProfile().totals(budget.site);
+    double allocations = double(totals.allocations) / max<uint64_t>(totals.operations, 1);
+    double bytes = double(totals.bytes) / max<uint64_t>(totals.operations, 1);
+    bool ok = allocations <= budget.allocations && bytes <= budget.bytes;
+    char line[160];
+    snprintf(line, sizeof(line), "%-16s %8.2f allocs (budget %5.2f) %10.1f bytes (budget %7.1f)  %s\n",
+             allocationSiteName(budget.site), allocations, budget.allocations, bytes, budget.bytes,
+             ok ? "ok" : "OVER BUDGET");
+    cout << line;
+    return ok;
+}
+
+// Lists the book the way listing, export and backup do: every field of each
+// appointment formatted into a stack line. forEachAppointment attributes the
+// cost to AllocationSite::ListedRecord.
+size_t listEveryRecord(ServiceCenter& center) {
+    size_t bytes = 0;
+    char line[512];
+    center.forEachAppointment([&](const ServiceAppointment& apt) {
+        bytes += ServiceCenter::formatBookLine(apt, line, sizeof(line));
+    });
+    return bytes;
+}
+
+// Returns false when any site exceeds its budget
+bool benchmarkAllocations() {
+#ifdef NO_ALLOCATION_HOOKS
+    cerr << "Allocation hooks are compiled out (NO_ALLOCATION_HOOKS)" << endl;
+    return false;
+#else
+    const size_t bookings = 20000;
+    ServiceCenter center;
+    center.setNotificationsEnabled(false);
+    const Service& oil = center.addService(make_unique<OilChange>());
+    const Service& engine = center.addService(make_unique<EngineRepair>("Clutch overhaul"));
+    vector<Client*> clients;
+    for (size_t i = 0; i < 500; ++i) {
+        clients.push_back(&center.addClient("Budget client " + to_string(i), "98460" + to_string(10000 + i)));
+    }
+    vector<pair<string, string>> booked;
+    for (size_t i = 0; i < bookings; ++i) {
+        booked.emplace_back("KA" + to_string(10 + i % 90) + "CD" + to_string(i),
+                            formatDate(daysFromCivil(2025, 1, 1) + static_cast<int32_t>(i % 365)));
+    }
+
+    AllocationProfile& profile = allocationProfile();
+    profile.reset();
+    profile.setEnabled(true);
+    for (size_t i = 0; i < bookings; ++i) {
+        center.addAppointment(*clients[i % clients.size()], booked[i].first, i % 4 ? oil : engine, booked[i].second);
+    }
+    for (size_t i = 0; i < bookings; ++i) {
+        center.progressAppointment(booked[i].first, booked[i].second);
+        center.progressAppointment(booked[i].first, booked[i].second);
+    }
+    listEveryRecord(center);
+    profile.setEnabled(false);
+
+    bool withinBudget = true;
+    for (const auto& budget : kAllocationBudgets) withinBudget &= checkAllocationBudget(budget);
+    return withinBudget;
+#endif
+}
+
+// Zero-allocation listing check: books every service kind, moves bookings
+// through each status, then lists the whole book. Fails when a listed
+// appointment costs more than its kAllocationBudgets entry (none).
+bool benchmarkListing() {
+#ifdef NO_ALLOCATION_HOOKS
+    cerr << "Allocation hooks are compiled out (NO_ALLOCATION_HOOKS)" << endl;
+    return false;
+#else
+    const size_t bookings = 5000;
+    ServiceCenter center;
+    center.setNotificationsEnabled(false);
+    const Service& oil = center.addService(make_unique<OilChange>());
+    const Service& engine = center.addService(make_unique<EngineRepair>("Timing belt replacement"));
+    Client& client = center.addClient("Listing client", "9846099999");
+    for (size_t i = 0; i < bookings; ++i) {
+        string plate = "KA" + to_string(10 + i % 90) + "LS" + to_string(i);
+        string date = formatDate(daysFromCivil(2025, 1, 1) + static_cast<int32_t>(i % 365));
+        center.addAppointment(client, plate, i % 2 ? oil : engine, date);
+        for (size_t step = 0; step < i % 3; ++step) center.progressAppointment(plate, date);
+    }
+
+    AllocationProfile& profile = allocationProfile();
+    profile.reset();
+    profile.setEnabled(true);
+    size_t bytes = listEveryRecord(center);
+    profile.setEnabled(false);
+
+    cout << bookings << " appointments listed, " << bytes << " bytes formatted\n";
+    for (const auto& budget : kAllocationBudgets) {
+        if (budget.site == AllocationSite::ListedRecord) return checkAllocationBudget(budget);
+    }
+    return false;
+#endif
+}
+
+// arg is the optional third command-line word, e.g. a problem size
+int runBenchmark(const string& name, const char* arg) {
+    if (name == "runtime") {
+        benchmarkRuntime();
+    } else if (name == "sketches") {
+        benchmarkSketches();
+    } else if (name == "search") {
+        benchmarkSearch();
+    } else if (name == "normalize") {
+        benchmarkNormalization();
+    } else if (name == "memory") {
+        benchmarkMemory();
+    } else if (name == "readers") {
+        benchmarkReaders();
+    } else if (name == "admission") {
+        benchmarkAdmission();
+    } else if (name == "tracing") {
+        benchmarkTracing();
+#ifdef __linux__
+    } else if (name == "io") {
+        benchmarkAsyncIo();
+    } else if (name == "shm") {
+        benchmarkSharedStore();
+#endif
+    } else if (name == "backup") {
+        benchmarkBackup(arg ? stoul(arg) : 10000000);
+    } else if (name == "catalog") {
+        benchmarkCatalog();
+    } else if (name == "observers") {
+        benchmarkObservers();
+    } else if (name == "calendar") {
+        benchmarkCalendar();
+    } else if (name == "reports") {
+        benchmarkReports();
+    } else if (name == "simulate") {
+        benchmarkSimulation();
+    } else if (name == "assign") {
+        benchmarkAssignment();
+    } else if (name == "alloc") {
+        if (!benchmarkAllocations()) return 1;
+    } else if (name == "listing") {
+        if (!benchmarkListing()) return 1;
+    } else {
+        cerr << "Unknown benchmark: " << name << endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 3 && string(argv[1]) == "--bench") {
+        return runBenchmark(argv[2], argc >= 4 ? argv[3] : nullptr);
+    }
+    // --simulate [days] [bays] [bookingsPerDay]
+    if (argc >= 2 && string(argv[1]) == "--simulate") {
+        try {
+            SimulationConfig config;
+            if (argc >= 3) config.days = stoi(argv[2]);
+            if (argc >= 4) config.bays = stoul(argv[3]);
+            if (argc >= 5) config.bookingsPerDay = stod(argv[4]);
+            // Simulate on the site's workflows, as the menu does
+            if (ifstream("workflows.conf")) config.workflowFile = "workflows.conf";
+            printSimulationReport(config, ServiceCenterSimulator(config).run());
+        } catch (const exception& e) {
+            cerr << "Error: " << e.what() << endl;
+            return 1;
+        }
+        return 0;
+    }
+#ifdef __linux__
+    if (argc >= 3 && string(argv[1]) == "--shm-reader") return printSharedStore(argv[2]);
+#endif
+
+    ServiceCenter serviceCenter;
+    int option;
+
+    // One booking per service bay per day
+    serviceCenter.setDailyCapacity(8);
+    AdmissionController admission;
+    BookingGateway gateway(serviceCenter, admission);
+    BackupHandle backup;
+    map<string, shared_ptr<Watcher>> watchers;   // options 18 and 19
+#ifdef __linux__
+    // Exports and the optional --journal <path> write through io_uring;
+    // --shm <name> mirrors the book for --shm-reader processes
+    AsyncIo asyncIo;
+    unique_ptr<AsyncFile> journal;
+    unique_ptr<SharedAppointmentStore> sharedStore;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        try {
+            if (string(argv[i]) == "--journal") {
+                journal = make_unique<AsyncFile>(asyncIo, argv[i + 1]);
+                serviceCenter.setJournal(journal.get());
+            } else if (string(argv[i]) == "--shm") {
+                sharedStore = make_unique<SharedAppointmentStore>(argv[i + 1]);
+                serviceCenter.setSharedStore(sharedStore.get());
+            }
+        } catch (const exception& e) {
+            cerr << "Error: " << e.what() << endl;
+            return 1;
+        }
+    }
+#endif
+
+    // Site workflow overrides the built-in one when present
+    ifstream workflowConfig("workflows.conf");
+    if (workflowConfig) {
+        try {
+            serviceCenter.loadWorkflows(workflowConfig);
+        } catch (const exception& e) {
+            cerr << "Error: " << e.what() << endl;
+        }
+    }
+
+    // Likewise the site service catalog; option 15 reloads it while running
+    ifstream catalogConfig("services.conf");
+    if (catalogConfig) {
+        try {
+            serviceCenter.loadServiceCatalog(catalogConfig);
+        } catch (const exception& e) {
+            cerr << "Error: " << e.what() << endl;
+        }
+    }
+
+    // Closures and holidays; without the file the center is open every day
+    ifstream calendarConfig("calendar.conf");
+    if (calendarConfig) {
+        try {
+            serviceCenter.loadCalendar(calendarConfig);
+        } catch (const exception& e) {
+            cerr << "Error: " << e.what() << endl;
+        }
+    }
+
+    while (true) {
+#ifdef __linux__
+        // The last command's journal lines reach the disk before the next
+        // prompt, and a failed journal write is reported right away
+        if (journal) {
+            try {
+                journal->sync();
+            } catch (const exception& e) {
+                cerr << "Error: " << e.what() << endl;
+            }
+        }
+#endif
+        if (backup.child) {
+            try {
+                if (ServiceCenter::finishBackup(backup, false)) cout << "\nBackup written to " << backup.path << "\n";
+            } catch (const exception& e) {
+                cerr << "Error: " << e.what() << endl;
+            }
+        }
+        cout << "\nVehicle Service Center Management\n"
+             << "1. Schedule New Appointment\n"
+             << "2. View Appointments\n"
+             << "3. Progress Appointment\n"
+             << "4. View Vehicle History\n"
+             << "5. Send Due-for-Service Reminders\n"
+             << "6. View Dashboard\n"
+             << "7. View Ops Board\n"
+             << "8. Search Vehicles and Clients\n"
+             << "9. Apply Workflow Event\n"
+             << "10. Load Workflow Config\n"
+             << "11. Reschedule Appointment\n"
+             << "12. Tracing (on/off/export)\n"
+             << "13. View Memory Usage\n"
+             << "14. Plan Technician Assignments\n"
+             << "15. Reload Service Catalog\n"
+             << "16. Back Up Appointment Book\n"
+             << "17. Export Appointments\n"
+             << "18. Watch Appointments\n"
+             << "19. Stop Watching\n"
+             << "20. Find Open Dates\n"
+             << "21. Print Work Sheets and Invoices\n"
+             << "22. Exit\n"
+             << "Enter your choice: ";
+        
+        cin >> option;
+        cin.ignore();
+
+        try {
+            if (option == 1) {
+                BookingFields fields;
+                string serviceType;
+                // Read sections stay short: one held across a prompt would stall
+                // catalog reclamation for as long as the desk takes to answer
+                string keys = serviceCenter.readCatalog()->keys();
+                
+                cout << "Enter client name: ";
+                getline(cin, fields.clientName);
+                cout << "Enter contact number: ";
+                getline(cin, fields.contact);
+                cout << "Enter vehicle number: ";
+                getline(cin, fields.vehicleNumber);
+                cout << "Enter appointment date (DD-MM-YYYY): ";
+                getline(cin, fields.date);
+                cout << "Enter service type (" << keys << "): ";
+                getline(cin, serviceType);
+                string channel;
+                cout << "Enter booking channel (fleet/walkin/web) [walkin]: ";
+                getline(cin, channel);
+
+                uint8_t errors = normalizeBooking(fields);
+                if (errors) {
+                    throw invalid_argument(describeBookingErrors(errors));
+                }
+
+                // The entry is copied out, so the booking finishes against the
+                // version it was resolved in even if the catalog is reloaded
+                CatalogEntry entry;
+                {
+                    auto catalog = serviceCenter.readCatalog();
+                    const CatalogEntry* found = catalog->find(serviceType);
+                    if (!found) {
+                        throw invalid_argument("Invalid service type");
+                    }
+                    entry = *found;
+                }
+                string detail;
+                if (!entry.detailPrompt.empty()) {
+                    cout << entry.detailPrompt << ": ";
+                    getline(cin, detail);
+                }
+
+                PriorityClass priority = PriorityClass::WalkIn;
+                if (channel == "fleet") {
+                    priority = PriorityClass::Fleet;
+                } else if (channel == "web") {
+                    priority = PriorityClass::Web;
+                } else if (!channel.empty() && channel != "walkin") {
+                    throw invalid_argument("Invalid booking channel");
+                }
+
+                Client& client = serviceCenter.addClient(fields.clientName, fields.contact);
+                if (gateway.book(priority, client, fields.vehicleNumber,
+                                 serviceCenter.addCatalogService(entry, detail), fields.date)) {
+                    cout << "Appointment scheduled successfully!\n";
+                } else {
+                    cout << "Request added to the waitlist.\n";
+                }
+            }
+            else if (option == 2) {
+                serviceCenter.viewAppointments();
+            }
+            else if (option == 3) {
+                string vehicleNum, date;
+                cout << "Enter vehicle number: ";
+                getline(cin, vehicleNum);
+                cout << "Enter appointment date (DD-MM-YYYY): ";
+                getline(cin, date);
+                serviceCenter.progressAppointment(vehicleNum, date);
+                cout << "Appointment status updated.\n";
+            }
+            else if (option == 4) {
+                string vehicleNum;
+                cout << "Enter vehicle number: ";
+                getline(cin, vehicleNum);
+                serviceCenter.viewVehicleHistory(vehicleNum);
+            }
+            else if (option == 5) {
+                string today;
+                cout << "Enter today's date (DD-MM-YYYY): ";
+                getline(cin, today);
+                int32_t day = parseDate(normalizeDate(today));
+                if (day == kInvalidDay) {
+                    throw invalid_argument("Invalid date");
+                }
+                size_t sent = serviceCenter.notifyDueOilChanges(day);
+                cout << sent << " vehicle(s) due for an oil change.\n";
+            }
+            else if (option == 6) {
+                string from, to;
+                cout << "Enter start date (DD-MM-YYYY): ";
+                getline(cin, from);
+                cout << "Enter end date (DD-MM-YYYY): ";
+                getline(cin, to);
+                int32_t fromDay = parseDate(normalizeDate(from));
+                int32_t toDay = parseDate(normalizeDate(to));
+                if (fromDay == kInvalidDay || toDay == kInvalidDay) {
+                    throw invalid_argument("Invalid date");
+                }
+                serviceCenter.viewDashboard(fromDay, toDay);
+            }
+            else if (option == 7) {
+                string today;
+                cout << "Enter today's date (DD-MM-YYYY): ";
+                getline(cin, today);
+                int32_t day = parseDate(normalizeDate(today));
+                if (day == kInvalidDay) {
+                    throw invalid_argument("Invalid date");
+                }
+                serviceCenter.viewOpsBoard(day);
+            }
+            else if (option == 8) {
+                string query;
+                cout << "Enter plate prefix or client name: ";
+                getline(cin, query);
+                serviceCenter.search(query);
+            }
+            else if (option == 9) {
+                string vehicleNum, date, event;
+                cout << "Enter vehicle number: ";
+                getline(cin, vehicleNum);
+                cout << "Enter appointment date (DD-MM-YYYY): ";
+                getline(cin, date);
+                cout << "Enter workflow event (e.g. checkin, cancel): ";
+                getline(cin, event);
+                serviceCenter.applyEvent(vehicleNum, date, event);
+                cout << "Appointment status updated.\n";
+            }
+            else if (option == 10) {
+                string path;
+                cout << "Enter workflow config path: ";
+                getline(cin, path);
+                serviceCenter.loadWorkflowFile(path);
+                cout << "Workflow config loaded.\n";
+            }
+            else if (option == 11) {
+                string vehicleNum, oldDate, newDate;
+                cout << "Enter vehicle number: ";
+                getline(cin, vehicleNum);
+                cout << "Enter current appointment date (DD-MM-YYYY): ";
+                getline(cin, oldDate);
+                cout << "Enter new appointment date (DD-MM-YYYY): ";
+                getline(cin, newDate);
+                serviceCenter.rescheduleAppointment(vehicleNum, oldDate, newDate);
+                cout << "Appointment rescheduled.\n";
+            }
+            else if (option == 12) {
+                string command;
+                cout << "Enter tracing command (on/off/export): ";
+                getline(cin, command);
+                if (command == "on" || command == "off") {
+                    tracer().setEnabled(command == "on");
+                    cout << "Tracing " << (command == "on" ? "enabled" : "disabled") << ".\n";
+                } else if (command == "export") {
+                    string path;
+                    cout << "Enter trace file path [trace.json]: ";
+                    getline(cin, path);
+                    ofstream out(path.empty() ? "trace.json" : path);
+                    if (!out) throw runtime_error("Cannot open trace file");
+                    size_t spans = tracer().exportChromeJson(out);
+                    cout << spans << " span(s) written; open in chrome://tracing or ui.perfetto.dev\n";
+                } else {
+                    throw invalid_argument("Invalid tracing command");
+                }
+            }
+            else if (option == 13) {
+                serviceCenter.viewMemory();
+            }
+            else if (option == 14) {
+                string date, line, goal;
+                cout << "Enter date (DD-MM-YYYY): ";
+                getline(cin, date);
+                int32_t day = parseDate(normalizeDate(date));
+                if (day == kInvalidDay) throw invalid_argument("Invalid date");
+                vector<Technician> technicians;
+                cout << "Enter technicians as 'name skills start end' (e.g. Ravi oil,engine 09:00 17:00),"
+                     << " blank line to finish:\n";
+                while (getline(cin, line) && !line.empty()) {
+                    istringstream fields(line);
+                    string name, skills, start, end;
+                    if (!(fields >> name >> skills >> start >> end)) throw invalid_argument("Invalid technician line");
+                    Technician tech{name, parseSkills(skills), parseClock(start), parseClock(end)};
+                    if (!tech.skills || tech.shiftStart < 0 || tech.shiftEnd <= tech.shiftStart) {
+                        throw invalid_argument("Invalid technician skills or shift");
+                    }
+                    technicians.push_back(tech);
+                }
+                if (technicians.empty()) throw invalid_argument("No technicians entered");
+                cout << "Minimize (overtime/makespan) [overtime]: ";
+                getline(cin, goal);
+                if (!goal.empty() && goal != "overtime" && goal != "makespan") {
+                    throw invalid_argument("Invalid objective");
+                }
+                serviceCenter.viewTechnicianPlan(day, technicians, goal == "makespan" ? AssignmentObjective::Makespan
+                                                                                  : AssignmentObjective::Overtime);
+            }
+            else if (option == 15) {
+                string path;
+                cout << "Enter service catalog path [services.conf]: ";
+                getline(cin, path);
+                uint64_t version = serviceCenter.loadServiceCatalogFile(path.empty() ? "services.conf" : path);
+                auto catalog = serviceCenter.readCatalog();
+                cout << "Service catalog version " << version << " published: " << catalog->keys() << "\n";
+            }
+            else if (option == 16) {
+                if (backup.child) throw runtime_error("A backup is already running");
+                string path;
+                cout << "Enter backup path [appointments.backup]: ";
+                getline(cin, path);
+                backup = serviceCenter.startBackup(path.empty() ? "appointments.backup" : path);
+                cout << "Backing up " << backup.appointments << " appointment(s) to " << backup.path
+                     << "; bookings paused for " << backup.stallNs / 1000 << " us\n";
+            }
+            else if (option == 17) {
+                string path;
+                cout << "Enter export path [appointments.csv]: ";
+                getline(cin, path);
+                if (path.empty()) path = "appointments.csv";
+#ifdef __linux__
+                AsyncFile out(asyncIo, path);
+                serviceCenter.exportAppointments(out);
+                out.close();
+                cout << out.bytesWritten() << " bytes exported via " << asyncIo.io().name() << "\n";
+#else
+                serviceCenter.startBackup(path, false);
+                cout << "Appointments exported.\n";
+#endif
+            }
+            else if (option == 18) {
+                string name, vehicleNum, date;
+                cout << "Enter watcher name: ";
+                getline(cin, name);
+                if (name.empty()) throw invalid_argument("Watcher name is required");
+                cout << "Enter vehicle number (blank for every appointment): ";
+                getline(cin, vehicleNum);
+                shared_ptr<Watcher>& watcher = watchers[name];
+                if (!watcher) watcher = make_shared<Watcher>(name);
+                if (vehicleNum.empty()) {
+                    serviceCenter.subscribe(watcher);
+                    cout << name << " is watching every appointment.\n";
+                } else {
+                    cout << "Enter appointment date (DD-MM-YYYY): ";
+                    getline(cin, date);
+                    serviceCenter.subscribe(vehicleNum, date, watcher);
+                    cout << name << " is watching " << vehicleNum << " on " << date << ".\n";
+                }
+            }
+            else if (option == 19) {
+                string name;
+                cout << "Enter watcher name: ";
+                getline(cin, name);
+                // Subscriptions are weak, so releasing the watcher ends them all
+                if (watchers.erase(name)) cout << name << " stopped watching.\n";
+                else cout << "No such watcher.\n";
+            }
+            else if (option == 20) {
+                string from, count;
+                cout << "Enter start date (DD-MM-YYYY): ";
+                getline(cin, from);
+                cout << "How many dates [5]: ";
+                getline(cin, count);
+                vector<OpenSlot> slots = serviceCenter.findOpenSlots(from, count.empty() ? 5 : stoul(count));
+                if (slots.empty()) cout << "No open dates in the next two years.\n";
+                for (const OpenSlot& slot : slots) {
+                    cout << formatDate(slot.day) << " " << BusinessCalendar::kWeekdayNames[BusinessCalendar::weekday(slot.day)];
+                    if (slot.remaining != UINT32_MAX) cout << ", " << slot.remaining << " slots left";
+                    if (slot.reduced) cout << " (reduced capacity)";
+                    cout << "\n";
+                }
+            }
+            else if (option == 21) {
+                string date, bays, path;
+                cout << "Enter date (DD-MM-YYYY): ";
+                getline(cin, date);
+                int32_t day = parseDate(normalizeDate(date));
+                if (day == kInvalidDay) throw invalid_argument("Invalid date");
+                cout << "Number of bays [8]: ";
+                getline(cin, bays);
+                cout << "Enter report path [reports.txt]: ";
+                getline(cin, path);
+                if (path.empty()) path = "reports.txt";
+
+                ReportBatch batch;
+                serviceCenter.collectWorkSheets(day, bays.empty() ? 8 : stoul(bays), "Main", batch);
+                serviceCenter.collectInvoices(day, "Main", batch);
+                ReportPipeline pipeline;
+#ifdef __linux__
+                AsyncFile out(asyncIo, path);
+                ReportStats stats = pipeline.run(batch, [&](string_view text) { out.append(text); });
+                out.close();
+#else
+                ofstream out(path, ios::binary);
+                ReportStats stats = pipeline.run(batch, [&](string_view text) { out.write(text.data(), text.size()); });
+#endif
+                cout << stats.documents << " documents (" << stats.bytes << " bytes) written to " << path << "\n";
+            }
+            else if (option == 22) {
+                ServiceCenter::finishBackup(backup);
                 cout << "Exiting system...\n";
                 break;
             }